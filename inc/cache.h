@@ -4,18 +4,50 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdatomic.h>
 #include <pthread.h>
 
+// Releases the owner of externally held pixel data (see cache_add_external)
+typedef void (*cache_release_fn)(void *owner);
+
+// CHANGED 2026-10-16 - Compressed cache entries - Problem: raw RGBA fits about 7 4K images in 256 MB
+// How an entry stores its pixels
+typedef enum {
+    CACHE_FORMAT_RGBA = 0,         // Raw RGBA, width * height * 4 bytes
+    CACHE_FORMAT_GPU,              // Compressed texture blocks in gl_format, for glCompressedTexImage2D
+    CACHE_FORMAT_ZSTD              // Lossless zstd of the RGBA, see cache_entry_decode()
+} cache_format_t;
+
+// --cache-compress modes
+typedef enum {
+    CACHE_COMPRESS_OFF = 0,        // Raw RGBA
+    CACHE_COMPRESS_AUTO,           // GPU format the driver can encode, else lossless
+    CACHE_COMPRESS_LOSSLESS        // zstd only (needs HAVE_ZSTD)
+} cache_compress_t;
+
 // Single cached image entry
+// CHANGED 2026-10-16 - Reference-counted, immutable entries - Problem: cache hits copied the whole image
+// with g_memdup2 and cache_get() returned a pointer that a concurrent eviction could free
+// Fields above the mutex-guarded ones are fixed once the entry is added. The cache holds one
+// reference while the entry is in it; cache_get()/cache_add() hand out another, which keeps data
+// valid after eviction until cache_entry_unref().
 typedef struct cache_entry {
     char *path;                    // Absolute file path (key)
-    unsigned char *data;           // Decoded RGBA pixel data
-    size_t size;                   // Size in bytes (width * height * 4)
+    const unsigned char *data;     // Pixel data in format, never written
+    size_t size;                   // Size of data in bytes (width * height * 4 for RGBA)
+    cache_format_t format;
+    uint32_t gl_format;            // Compressed internal format for CACHE_FORMAT_GPU
     int width;                     // Image width
     int height;                    // Image height
-    uint64_t last_used;            // Timestamp for LRU (monotonic ns)
+    cache_release_fn release;      // Frees data via owner; NULL means data came from malloc
+    void *owner;
+    atomic_int refcount;
+    // Guarded by the cache mutex
+    uint64_t last_used;            // Timestamp of last use (monotonic ns)
     bool currently_displayed;      // True if actively shown on a monitor
-    struct cache_entry *next;      // Linked list pointer
+    struct cache_entry *hash_next; // Next entry in the same hash bucket
+    struct cache_entry *lru_prev;  // Recency list (see cache.c), toward most recent
+    struct cache_entry *lru_next;  // Recency list, toward least recent
 } cache_entry_t;
 
 // Cache manager (opaque, defined in cache.c)
@@ -34,15 +66,65 @@ void cache_shutdown(void);
 bool cache_enabled(void);
 
 // Get cached entry by path, returns NULL if not found
-// Updates last_used timestamp on hit
+// Updates last_used timestamp on hit. Returns a reference; release it with cache_entry_unref()
 cache_entry_t *cache_get(const char *path);
 
-// Add image to cache, returns entry pointer
+// Add image to cache, returns a reference to the entry (or NULL); release it with cache_entry_unref()
 // May evict LRU entries if cache is full
-// Takes ownership of data pointer (will free on eviction)
+// Takes ownership of data pointer (malloc'd, freed with the last reference)
+// If path is already cached, data is freed and the existing entry returned
 cache_entry_t *cache_add(const char *path, unsigned char *data,
                          int width, int height);
 
+// Like cache_add() for pixels owned by something else (e.g. a mapped GstBuffer):
+// data stays valid until release(owner), called with the last reference.
+// release(owner) is also called right away if the entry can't be added
+cache_entry_t *cache_add_external(const char *path, const unsigned char *data,
+                                  int width, int height,
+                                  cache_release_fn release, void *owner);
+
+// Wrap pixels in an entry that isn't in the cache (for when caching is off);
+// returns the only reference, or NULL after calling release(owner)
+cache_entry_t *cache_entry_wrap(const unsigned char *data, int width, int height,
+                                cache_release_fn release, void *owner);
+
+// Wrap pixels already encoded in format (malloc'd, freed with the last
+// reference) in an entry that isn't in the cache
+cache_entry_t *cache_entry_wrap_encoded(unsigned char *data, size_t size, int width, int height,
+                                        cache_format_t format, uint32_t gl_format);
+
+// Prepare RGBA pixels (an entry from cache_entry_wrap) for the cache: with
+// lossless compression on, a zstd copy outside the cache if that saves space,
+// otherwise another reference to rgba. Slow when compressing; call it before
+// taking locks.
+cache_entry_t *cache_pack(cache_entry_t *rgba);
+
+// Add an entry made outside the cache (cache_entry_wrap, cache_pack) under
+// path, sharing its pixels. Returns a reference to the cached entry.
+cache_entry_t *cache_insert(const char *path, cache_entry_t *entry);
+
+// Swap current, a cached entry, for an entry made outside the cache (a packed
+// copy of it), keeping its place in the recency order and its displayed mark.
+// Does nothing and returns false if current has left the cache meanwhile.
+bool cache_replace(const cache_entry_t *current, cache_entry_t *replacement);
+
+// Choose how new entries are stored; lossless falls back to raw RGBA without zstd
+void cache_set_compression(cache_compress_t mode);
+cache_compress_t cache_compression(void);
+
+// True if built with zstd (HAVE_ZSTD)
+bool cache_lossless_available(void);
+
+// Decompress a CACHE_FORMAT_ZSTD entry into a new RGBA entry outside the cache
+// (the only reference). Returns NULL on failure or for other formats.
+cache_entry_t *cache_entry_decode(const cache_entry_t *entry);
+
+// Take another reference to an entry
+cache_entry_t *cache_entry_ref(cache_entry_t *entry);
+
+// Drop a reference; the last one frees the pixels. Safe after cache_shutdown()
+void cache_entry_unref(cache_entry_t *entry);
+
 // Remove specific entry from cache
 void cache_remove(const char *path);
 
@@ -0,0 +1,34 @@
+#ifndef DISKCACHE_H
+#define DISKCACHE_H
+
+#include <stddef.h>
+#include "cache.h"
+
+// On-disk tier behind the image cache (--disk-cache MB).
+// Decoded RGBA images are kept under $XDG_CACHE_HOME/gslapper (or
+// ~/.cache/gslapper), one file per source path: a header recording the
+// source's mtime and size plus a checksum, then the raw pixels. Loading
+// maps the file, so a cached startup image skips decoding altogether.
+// The least recently used files are pruned to stay within the limit.
+
+// Initialize with the size limit in MB (0 disables the disk tier)
+void diskcache_init(size_t max_size_mb);
+
+// Finish the write in progress, drop queued ones and disable the disk tier
+void diskcache_shutdown(void);
+
+// Check if the disk tier is enabled
+bool diskcache_enabled(void);
+
+// Map the cached pixels of path (resolved, the cache key) if they are stored
+// and the source hasn't changed since. The entry is added to the memory cache
+// when it is enabled. Returns a reference (cache_entry_unref), NULL on a miss;
+// stale or corrupt files are deleted.
+cache_entry_t *diskcache_load(const char *path);
+
+// Queue entry's pixels for path to the writer thread, which also prunes old
+// files. Takes its own reference to entry; skipped while DISKCACHE_QUEUE_MAX
+// writes are waiting.
+void diskcache_store(const char *path, cache_entry_t *entry);
+
+#endif // DISKCACHE_H
@@ -0,0 +1,46 @@
+#ifndef PRELOAD_H
+#define PRELOAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "cache.h"
+
+// Background image decoding for the IPC `preload` command.
+// A small pool of worker threads decodes queued images to RGBA with their
+// own GStreamer pipelines and hands the pixels to cache_add(), so a later
+// `change` to the same path is a cache hit. Workers start on the first job.
+// The same workers also compress images the main loop cached (preload_pack()).
+
+// Decode threads in the pool
+#define PRELOAD_WORKERS 2
+
+// Jobs waiting for a worker; further preloads are refused
+#define PRELOAD_QUEUE_MAX 64
+
+typedef enum {
+    PRELOAD_QUEUED = 0,    // Job added to the queue
+    PRELOAD_PENDING,       // Path already queued or being decoded
+    PRELOAD_QUEUE_FULL,    // PRELOAD_QUEUE_MAX jobs waiting
+    PRELOAD_FAILED         // Out of memory or workers could not start
+} preload_result_t;
+
+// Queue path (resolved, the cache key) for decoding into the cache.
+// Paths already queued or being decoded are not queued twice.
+preload_result_t preload_submit(const char *path);
+
+// Compress a cached entry (--cache-compress, with zstd) on a worker and swap
+// the result in with cache_replace(), keeping the main loop free of it.
+// Takes its own reference. Returns false if nothing was queued.
+bool preload_pack(cache_entry_t *entry);
+
+// Drop a queued job for path and abandon its decode if one is running;
+// path NULL cancels every job. Returns how many jobs were cancelled.
+int preload_cancel(const char *path);
+
+// Format queued and running jobs for IPC response (caller provides buffer)
+void preload_list(char *buffer, size_t buflen);
+
+// Cancel all jobs and join the workers
+void preload_shutdown(void);
+
+#endif // PRELOAD_H
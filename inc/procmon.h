@@ -0,0 +1,37 @@
+#ifndef PROCMON_H
+#define PROCMON_H
+
+#include <stdbool.h>
+
+// In-process replacement for `pidof` on the pauselist/stoplist.
+// Subscribes to the kernel proc connector (netlink PROC_EVENT_EXEC/EXIT)
+// when the kernel acknowledges the subscription, otherwise rescans /proc
+// once per update.
+// Processes are matched on /proc/<pid>/comm, like pidof. Never forks.
+
+// Watcher (opaque, defined in procmon.c)
+typedef struct procmon procmon_t;
+
+// Create a watcher for the names in one or more NULL-terminated lists
+// (NULL lists are skipped). Waits up to 200 ms for the proc connector to
+// acknowledge the subscription. Returns NULL on allocation failure.
+procmon_t *procmon_create(char **const *lists, int n_lists);
+
+// Unsubscribe, close the netlink socket and free the watcher
+void procmon_destroy(procmon_t *pm);
+
+// Proc connector socket to poll() for process events, or -1 when /proc is scanned
+int procmon_get_fd(const procmon_t *pm);
+
+// Bring the running set up to date without blocking: drain pending process
+// events, or rescan /proc when events are unavailable (call once per tick)
+void procmon_update(procmon_t *pm);
+
+// First name in list that is running, or NULL (list must have been passed to procmon_create)
+const char *procmon_find(const procmon_t *pm, char **list);
+
+// One-off /proc scan for a NULL-terminated list; sets running[i] for each
+// name found (running may be NULL) and returns how many are running
+int procmon_scan(char **names, bool *running);
+
+#endif // PROCMON_H
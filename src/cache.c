@@ -2,12 +2,33 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
 #include "cache.h"
 #include "cflogprinter.h"
 
+// zstd level for lossless entries: level 1 compresses a 4K image in well under
+// a second and decompresses it in tens of milliseconds
+#define CACHE_ZSTD_LEVEL 1
+
+// Initial hash table size (power of two); doubles when entries outnumber buckets
+#define CACHE_INITIAL_BUCKETS 64
+
+// Recency-ordered list, most recently used at head
+typedef struct {
+    cache_entry_t *head;
+    cache_entry_t *tail;
+} lru_list_t;
+
 // Cache manager structure
+// CHANGED 2026-10-16 - Hash table plus recency lists - Problem: lookups walked a linked list with strcmp and
+// eviction scanned every entry for the oldest last_used, both O(n) under the mutex
 struct image_cache {
-    cache_entry_t *entries;        // Linked list head
+    cache_entry_t **buckets;       // Hash table keyed on path
+    size_t n_buckets;              // Power of two
+    lru_list_t idle;               // Entries not on screen; evicted from the tail
+    lru_list_t displayed;          // Entries on screen; evicted only when nothing else is left
     size_t total_size;             // Current cache size in bytes
     size_t max_size;               // Limit in bytes
     pthread_mutex_t mutex;         // Thread safety
@@ -18,6 +39,9 @@ struct image_cache {
 // Global cache instance
 static image_cache_t *g_cache = NULL;
 
+// How new entries are stored (--cache-compress)
+static cache_compress_t compress_mode = CACHE_COMPRESS_OFF;
+
 // Get monotonic timestamp in nanoseconds
 static uint64_t get_timestamp_ns(void) {
     struct timespec ts;
@@ -25,6 +49,156 @@ static uint64_t get_timestamp_ns(void) {
     return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
 }
 
+// FNV-1a
+static uint64_t hash_path(const char *path) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)path; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static cache_entry_t **bucket_for(const char *path) {
+    return &g_cache->buckets[hash_path(path) & (g_cache->n_buckets - 1)];
+}
+
+static lru_list_t *list_of(cache_entry_t *entry) {
+    return entry->currently_displayed ? &g_cache->displayed : &g_cache->idle;
+}
+
+static void list_unlink(lru_list_t *list, cache_entry_t *entry) {
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        list->head = entry->lru_next;
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        list->tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void list_push_front(lru_list_t *list, cache_entry_t *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = list->head;
+    if (list->head)
+        list->head->lru_prev = entry;
+    else
+        list->tail = entry;
+    list->head = entry;
+}
+
+// Mark entry as just used (internal, caller must hold mutex)
+static void touch_entry(cache_entry_t *entry) {
+    entry->last_used = get_timestamp_ns();
+    lru_list_t *list = list_of(entry);
+    if (list->head != entry) {
+        list_unlink(list, entry);
+        list_push_front(list, entry);
+    }
+}
+
+// Double the bucket count (internal, caller must hold mutex); on allocation
+// failure the table just stays at its current size
+static void grow_table(void) {
+    size_t n_buckets = g_cache->n_buckets * 2;
+    cache_entry_t **buckets = calloc(n_buckets, sizeof(cache_entry_t *));
+    if (!buckets)
+        return;
+
+    for (size_t i = 0; i < g_cache->n_buckets; i++) {
+        cache_entry_t *entry = g_cache->buckets[i];
+        while (entry) {
+            cache_entry_t *next = entry->hash_next;
+            cache_entry_t **bucket = &buckets[hash_path(entry->path) & (n_buckets - 1)];
+            entry->hash_next = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    free(g_cache->buckets);
+    g_cache->buckets = buckets;
+    g_cache->n_buckets = n_buckets;
+}
+
+// Free pixels that didn't make it into an entry
+static void release_pixels(const unsigned char *data, cache_release_fn release, void *owner) {
+    if (release)
+        release(owner);
+    else
+        free((void *)data);
+}
+
+// Entry outside the cache with the only reference; NULL after releasing data
+static cache_entry_t *new_entry(const unsigned char *data, size_t size, int width, int height,
+                                cache_format_t format, uint32_t gl_format,
+                                cache_release_fn release, void *owner) {
+    cache_entry_t *entry = calloc(1, sizeof(cache_entry_t));
+    if (!entry) {
+        release_pixels(data, release, owner);
+        return NULL;
+    }
+    entry->data = data;
+    entry->size = size;
+    entry->format = format;
+    entry->gl_format = gl_format;
+    entry->width = width;
+    entry->height = height;
+    entry->release = release;
+    entry->owner = owner;
+    atomic_init(&entry->refcount, 1);
+    return entry;
+}
+
+cache_entry_t *cache_entry_wrap(const unsigned char *data, int width, int height,
+                                cache_release_fn release, void *owner) {
+    return new_entry(data, (size_t)width * height * 4, width, height,
+                     CACHE_FORMAT_RGBA, 0, release, owner);
+}
+
+cache_entry_t *cache_entry_ref(cache_entry_t *entry) {
+    if (entry)
+        atomic_fetch_add(&entry->refcount, 1);
+    return entry;
+}
+
+void cache_entry_unref(cache_entry_t *entry) {
+    if (!entry || atomic_fetch_sub(&entry->refcount, 1) != 1)
+        return;
+
+    if (entry->release)
+        entry->release(entry->owner);
+    else
+        free((void *)entry->data);
+    free(entry->path);
+    free(entry);
+}
+
+// Take entry out of the table and its list and drop the cache's reference
+// (internal, caller must hold mutex)
+static void remove_entry(cache_entry_t *entry) {
+    cache_entry_t **link = bucket_for(entry->path);
+    while (*link != entry)
+        link = &(*link)->hash_next;
+    *link = entry->hash_next;
+
+    list_unlink(list_of(entry), entry);
+    g_cache->total_size -= entry->size;
+    g_cache->entry_count--;
+    cache_entry_unref(entry);
+}
+
+// Free every entry in list (internal, caller must hold mutex); returns how many
+static int remove_list(lru_list_t *list) {
+    int count = 0;
+    while (list->head) {
+        remove_entry(list->head);
+        count++;
+    }
+    return count;
+}
+
 void cache_init(size_t max_size_mb) {
     if (g_cache != NULL) {
         cflp_warning("Cache already initialized");
@@ -42,6 +216,13 @@ void cache_init(size_t max_size_mb) {
     pthread_mutex_init(&g_cache->mutex, NULL);
 
     if (g_cache->enabled) {
+        g_cache->buckets = calloc(CACHE_INITIAL_BUCKETS, sizeof(cache_entry_t *));
+        if (!g_cache->buckets) {
+            cflp_error("Failed to allocate cache table, caching disabled");
+            g_cache->enabled = false;
+            return;
+        }
+        g_cache->n_buckets = CACHE_INITIAL_BUCKETS;
         cflp_info("Image cache initialized: %zu MB limit", max_size_mb);
     } else {
         cflp_info("Image cache disabled");
@@ -54,13 +235,10 @@ void cache_shutdown(void) {
     pthread_mutex_lock(&g_cache->mutex);
 
     // Free all entries
-    cache_entry_t *entry = g_cache->entries;
-    while (entry) {
-        cache_entry_t *next = entry->next;
-        free(entry->path);
-        free(entry->data);
-        free(entry);
-        entry = next;
+    if (g_cache->buckets) {
+        remove_list(&g_cache->idle);
+        remove_list(&g_cache->displayed);
+        free(g_cache->buckets);
     }
 
     pthread_mutex_unlock(&g_cache->mutex);
@@ -93,14 +271,14 @@ void cache_stats(size_t *used_bytes, size_t *max_bytes, int *entry_count) {
 
 // Find entry by path (internal, caller must hold mutex)
 static cache_entry_t *find_entry(const char *path) {
-    if (!g_cache || !path) return NULL;
+    if (!g_cache || !g_cache->buckets || !path) return NULL;
 
-    cache_entry_t *entry = g_cache->entries;
+    cache_entry_t *entry = *bucket_for(path);
     while (entry) {
         if (strcmp(entry->path, path) == 0) {
             return entry;
         }
-        entry = entry->next;
+        entry = entry->hash_next;
     }
     return NULL;
 }
@@ -110,10 +288,11 @@ cache_entry_t *cache_get(const char *path) {
 
     pthread_mutex_lock(&g_cache->mutex);
 
+    // The reference is taken under the mutex, so an eviction can't free the entry first
     cache_entry_t *entry = find_entry(path);
     if (entry) {
-        // Update LRU timestamp
-        entry->last_used = get_timestamp_ns();
+        touch_entry(entry);
+        cache_entry_ref(entry);
     }
 
     pthread_mutex_unlock(&g_cache->mutex);
@@ -132,107 +311,78 @@ bool cache_contains(const char *path) {
 
 // Evict least recently used entry (internal, caller must hold mutex)
 static void evict_lru(void) {
-    if (!g_cache || !g_cache->entries) return;
-
-    cache_entry_t *lru = NULL;
-    cache_entry_t *lru_prev = NULL;
-    cache_entry_t *prev = NULL;
-    cache_entry_t *entry = g_cache->entries;
-    uint64_t oldest = UINT64_MAX;
-
-    // Find LRU entry (prefer non-displayed entries)
-    while (entry) {
-        // Skip currently displayed entries unless they're the only option
-        if (!entry->currently_displayed && entry->last_used < oldest) {
-            oldest = entry->last_used;
-            lru = entry;
-            lru_prev = prev;
-        }
-        prev = entry;
-        entry = entry->next;
-    }
-
-    // If all entries are displayed, evict oldest anyway
-    if (!lru) {
-        prev = NULL;
-        entry = g_cache->entries;
-        oldest = UINT64_MAX;
-        while (entry) {
-            if (entry->last_used < oldest) {
-                oldest = entry->last_used;
-                lru = entry;
-                lru_prev = prev;
-            }
-            prev = entry;
-            entry = entry->next;
-        }
-    }
+    if (!g_cache) return;
 
+    // Prefer entries that aren't on screen; if all are displayed, evict oldest anyway
+    cache_entry_t *lru = g_cache->idle.tail;
+    if (!lru)
+        lru = g_cache->displayed.tail;
     if (!lru) return;
 
-    // Remove from list
-    if (lru_prev) {
-        lru_prev->next = lru->next;
-    } else {
-        g_cache->entries = lru->next;
-    }
-
-    g_cache->total_size -= lru->size;
-    g_cache->entry_count--;
-
     cflp_info("Cache evicted (LRU): %s (%.2f MB)",
               lru->path, (double)lru->size / (1024 * 1024));
 
-    free(lru->path);
-    free(lru->data);
-    free(lru);
+    remove_entry(lru);
 }
 
-cache_entry_t *cache_add(const char *path, unsigned char *data,
-                         int width, int height) {
+static cache_entry_t *add_entry(const char *path, const unsigned char *data, size_t size,
+                                int width, int height,
+                                cache_format_t format, uint32_t gl_format,
+                                cache_release_fn release, void *owner) {
     if (!g_cache || !g_cache->enabled || !path || !data) {
-        free(data);  // Take ownership, must free if not caching
+        release_pixels(data, release, owner);  // Take ownership, must free if not caching
         return NULL;
     }
 
-    size_t size = (size_t)width * height * 4;  // RGBA
-
     pthread_mutex_lock(&g_cache->mutex);
 
     // Check if already cached
     cache_entry_t *existing = find_entry(path);
     if (existing) {
+        cache_entry_ref(existing);
         pthread_mutex_unlock(&g_cache->mutex);
-        free(data);  // Don't need duplicate
+        release_pixels(data, release, owner);  // Don't need duplicate
         return existing;
     }
 
     // Evict until we have space
     while (g_cache->total_size + size > g_cache->max_size &&
-           g_cache->entries != NULL) {
+           g_cache->entry_count > 0) {
         evict_lru();
     }
 
     // Create new entry
     cache_entry_t *entry = calloc(1, sizeof(cache_entry_t));
-    if (!entry) {
+    char *key = strdup(path);
+    if (!entry || !key) {
         pthread_mutex_unlock(&g_cache->mutex);
-        free(data);
+        free(entry);
+        free(key);
+        release_pixels(data, release, owner);
         cflp_error("Failed to allocate cache entry");
         return NULL;
     }
 
-    entry->path = strdup(path);
+    entry->path = key;
     entry->data = data;
     entry->size = size;
+    entry->format = format;
+    entry->gl_format = gl_format;
     entry->width = width;
     entry->height = height;
+    entry->release = release;
+    entry->owner = owner;
+    atomic_init(&entry->refcount, 2);  // The cache's and the caller's
     entry->last_used = get_timestamp_ns();
     entry->currently_displayed = false;
 
-    // Add to front of list
-    entry->next = g_cache->entries;
-    g_cache->entries = entry;
+    if ((size_t)g_cache->entry_count >= g_cache->n_buckets)
+        grow_table();
+
+    cache_entry_t **bucket = bucket_for(path);
+    entry->hash_next = *bucket;
+    *bucket = entry;
+    list_push_front(&g_cache->idle, entry);
 
     g_cache->total_size += size;
     g_cache->entry_count++;
@@ -247,35 +397,167 @@ cache_entry_t *cache_add(const char *path, unsigned char *data,
     return entry;
 }
 
+cache_entry_t *cache_add(const char *path, unsigned char *data,
+                         int width, int height) {
+    return add_entry(path, data, (size_t)width * height * 4, width, height,
+                     CACHE_FORMAT_RGBA, 0, NULL, NULL);
+}
+
+cache_entry_t *cache_add_external(const char *path, const unsigned char *data,
+                                  int width, int height,
+                                  cache_release_fn release, void *owner) {
+    return add_entry(path, data, (size_t)width * height * 4, width, height,
+                     CACHE_FORMAT_RGBA, 0, release, owner);
+}
+
+cache_entry_t *cache_entry_wrap_encoded(unsigned char *data, size_t size, int width, int height,
+                                        cache_format_t format, uint32_t gl_format) {
+    return new_entry(data, size, width, height, format, gl_format, NULL, NULL);
+}
+
+static void release_shared_entry(void *owner) {
+    cache_entry_unref(owner);
+}
+
+cache_entry_t *cache_pack(cache_entry_t *rgba) {
+    if (!rgba || rgba->format != CACHE_FORMAT_RGBA)
+        return cache_entry_ref(rgba);
+#ifdef HAVE_ZSTD
+    if (compress_mode != CACHE_COMPRESS_OFF) {
+        // Skip it unless it saves at least an eighth
+        size_t bound = ZSTD_compressBound(rgba->size);
+        unsigned char *packed = malloc(bound);
+        size_t n = packed ? ZSTD_compress(packed, bound, rgba->data, rgba->size, CACHE_ZSTD_LEVEL) : 0;
+        if (packed && !ZSTD_isError(n) && n <= rgba->size - rgba->size / 8) {
+            unsigned char *shrunk = realloc(packed, n);
+            cache_entry_t *entry = new_entry(shrunk ? shrunk : packed, n, rgba->width, rgba->height,
+                                             CACHE_FORMAT_ZSTD, 0, NULL, NULL);
+            if (entry)
+                return entry;
+        } else {
+            free(packed);
+        }
+    }
+#endif
+    return cache_entry_ref(rgba);
+}
+
+cache_entry_t *cache_insert(const char *path, cache_entry_t *entry) {
+    if (!entry)
+        return NULL;
+    return add_entry(path, entry->data, entry->size, entry->width, entry->height,
+                     entry->format, entry->gl_format, release_shared_entry, cache_entry_ref(entry));
+}
+
+bool cache_replace(const cache_entry_t *current, cache_entry_t *replacement) {
+    if (!g_cache || !g_cache->enabled || !current || !replacement)
+        return false;
+
+    cache_entry_t *entry = calloc(1, sizeof(cache_entry_t));
+    char *key = strdup(current->path);
+    if (!entry || !key) {
+        free(entry);
+        free(key);
+        return false;
+    }
+    entry->path = key;
+    entry->data = replacement->data;
+    entry->size = replacement->size;
+    entry->format = replacement->format;
+    entry->gl_format = replacement->gl_format;
+    entry->width = replacement->width;
+    entry->height = replacement->height;
+    entry->release = release_shared_entry;
+    entry->owner = cache_entry_ref(replacement);
+    atomic_init(&entry->refcount, 1);  // The cache's
+
+    pthread_mutex_lock(&g_cache->mutex);
+
+    cache_entry_t **link = bucket_for(current->path);
+    while (*link && *link != current)
+        link = &(*link)->hash_next;
+    cache_entry_t *old = *link;
+    if (!old) {
+        // Evicted or unloaded while it was being packed
+        pthread_mutex_unlock(&g_cache->mutex);
+        cache_entry_unref(entry);
+        return false;
+    }
+
+    // Take over old's bucket slot and list position
+    entry->hash_next = old->hash_next;
+    *link = entry;
+    entry->last_used = old->last_used;
+    entry->currently_displayed = old->currently_displayed;
+    lru_list_t *list = list_of(old);
+    entry->lru_prev = old->lru_prev;
+    entry->lru_next = old->lru_next;
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry;
+    else
+        list->head = entry;
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry;
+    else
+        list->tail = entry;
+    g_cache->total_size = g_cache->total_size - old->size + entry->size;
+
+    cflp_info("Cache packed: %s (%.2f -> %.2f MB%s)", entry->path,
+              (double)old->size / (1024 * 1024), (double)entry->size / (1024 * 1024),
+              entry->format == CACHE_FORMAT_GPU ? ", gpu" : ", zstd");
+
+    pthread_mutex_unlock(&g_cache->mutex);
+    cache_entry_unref(old);
+    return true;
+}
+
+void cache_set_compression(cache_compress_t mode) {
+    if (mode == CACHE_COMPRESS_LOSSLESS && !cache_lossless_available())
+        cflp_warning("Built without zstd, lossless cache compression unavailable");
+    compress_mode = mode;
+}
+
+cache_compress_t cache_compression(void) {
+    return compress_mode;
+}
+
+bool cache_lossless_available(void) {
+#ifdef HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+cache_entry_t *cache_entry_decode(const cache_entry_t *entry) {
+    if (!entry || entry->format != CACHE_FORMAT_ZSTD)
+        return NULL;
+#ifdef HAVE_ZSTD
+    size_t size = (size_t)entry->width * entry->height * 4;
+    unsigned char *pixels = malloc(size);
+    if (!pixels)
+        return NULL;
+    size_t n = ZSTD_decompress(pixels, size, entry->data, entry->size);
+    if (ZSTD_isError(n) || n != size) {
+        cflp_error("Cache entry %s failed to decompress", entry->path);
+        free(pixels);
+        return NULL;
+    }
+    return cache_entry_wrap(pixels, entry->width, entry->height, NULL, NULL);
+#else
+    return NULL;
+#endif
+}
+
 void cache_remove(const char *path) {
     if (!g_cache || !path) return;
 
     pthread_mutex_lock(&g_cache->mutex);
 
-    cache_entry_t *prev = NULL;
-    cache_entry_t *entry = g_cache->entries;
-
-    while (entry) {
-        if (strcmp(entry->path, path) == 0) {
-            // Remove from list
-            if (prev) {
-                prev->next = entry->next;
-            } else {
-                g_cache->entries = entry->next;
-            }
-
-            g_cache->total_size -= entry->size;
-            g_cache->entry_count--;
-
-            cflp_info("Cache removed: %s", path);
-
-            free(entry->path);
-            free(entry->data);
-            free(entry);
-            break;
-        }
-        prev = entry;
-        entry = entry->next;
+    cache_entry_t *entry = find_entry(path);
+    if (entry) {
+        remove_entry(entry);
+        cflp_info("Cache removed: %s", path);
     }
 
     pthread_mutex_unlock(&g_cache->mutex);
@@ -286,21 +568,7 @@ void cache_clear(void) {
 
     pthread_mutex_lock(&g_cache->mutex);
 
-    cache_entry_t *entry = g_cache->entries;
-    int count = 0;
-
-    while (entry) {
-        cache_entry_t *next = entry->next;
-        free(entry->path);
-        free(entry->data);
-        free(entry);
-        entry = next;
-        count++;
-    }
-
-    g_cache->entries = NULL;
-    g_cache->total_size = 0;
-    g_cache->entry_count = 0;
+    int count = remove_list(&g_cache->idle) + remove_list(&g_cache->displayed);
 
     pthread_mutex_unlock(&g_cache->mutex);
 
@@ -312,34 +580,7 @@ void cache_clear_unused(void) {
 
     pthread_mutex_lock(&g_cache->mutex);
 
-    cache_entry_t *prev = NULL;
-    cache_entry_t *entry = g_cache->entries;
-    int count = 0;
-
-    while (entry) {
-        cache_entry_t *next = entry->next;
-
-        if (!entry->currently_displayed) {
-            // Remove from list
-            if (prev) {
-                prev->next = next;
-            } else {
-                g_cache->entries = next;
-            }
-
-            g_cache->total_size -= entry->size;
-            g_cache->entry_count--;
-            count++;
-
-            free(entry->path);
-            free(entry->data);
-            free(entry);
-        } else {
-            prev = entry;
-        }
-
-        entry = next;
-    }
+    int count = remove_list(&g_cache->idle);
 
     pthread_mutex_unlock(&g_cache->mutex);
 
@@ -352,13 +593,34 @@ void cache_set_displayed(const char *path, bool displayed) {
     pthread_mutex_lock(&g_cache->mutex);
 
     cache_entry_t *entry = find_entry(path);
-    if (entry) {
+    if (entry && entry->currently_displayed != displayed) {
+        list_unlink(list_of(entry), entry);
         entry->currently_displayed = displayed;
+        list_push_front(list_of(entry), entry);
     }
 
     pthread_mutex_unlock(&g_cache->mutex);
 }
 
+// Append one line per entry of list to buffer; returns false once the buffer is full
+static bool list_entries(const lru_list_t *list, char *buffer, size_t buflen, size_t *offset) {
+    for (cache_entry_t *entry = list->head; entry; entry = entry->lru_next) {
+        int written = snprintf(buffer + *offset, buflen - *offset,
+                               "%s %dx%d %.2fMB%s%s\n",
+                               entry->path,
+                               entry->width, entry->height,
+                               (double)entry->size / (1024 * 1024),
+                               entry->format == CACHE_FORMAT_GPU ? " gpu" :
+                               entry->format == CACHE_FORMAT_ZSTD ? " zstd" : "",
+                               entry->currently_displayed ? " *" : "");
+        if (written < 0 || (size_t)written >= buflen - *offset) {
+            return false;  // Buffer full
+        }
+        *offset += written;
+    }
+    return true;
+}
+
 void cache_list(char *buffer, size_t buflen) {
     if (!buffer || buflen == 0) return;
 
@@ -377,28 +639,16 @@ void cache_list(char *buffer, size_t buflen) {
         return;
     }
 
-    if (!g_cache->entries) {
+    if (g_cache->entry_count == 0) {
         pthread_mutex_unlock(&g_cache->mutex);
         snprintf(buffer, buflen, "Cache empty\n");
         return;
     }
 
+    // Displayed images first, then the rest from most to least recently used
     size_t offset = 0;
-    cache_entry_t *entry = g_cache->entries;
-
-    while (entry && offset < buflen - 1) {
-        int written = snprintf(buffer + offset, buflen - offset,
-                               "%s %dx%d %.2fMB%s\n",
-                               entry->path,
-                               entry->width, entry->height,
-                               (double)entry->size / (1024 * 1024),
-                               entry->currently_displayed ? " *" : "");
-        if (written < 0 || (size_t)written >= buflen - offset) {
-            break;  // Buffer full
-        }
-        offset += written;
-        entry = entry->next;
-    }
+    if (list_entries(&g_cache->displayed, buffer, buflen, &offset))
+        list_entries(&g_cache->idle, buffer, buflen, &offset);
 
     pthread_mutex_unlock(&g_cache->mutex);
 }
@@ -0,0 +1,505 @@
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "diskcache.h"
+#include "cflogprinter.h"
+
+#define DEFAULT_CACHE_DIR ".cache/gslapper"
+#define DISKCACHE_MAGIC "GSLPIMG"     // 8 bytes with the terminator
+#define DISKCACHE_VERSION 1
+#define DISKCACHE_SUFFIX ".rgba"
+#define DISKCACHE_TMP_SUFFIX ".tmp"
+#define DISKCACHE_ALIGN 64             // Pixels start on this boundary
+// Writes waiting for the writer thread; each holds a full image, so later
+// stores are skipped while this many are queued
+#define DISKCACHE_QUEUE_MAX 8
+// A temp file untouched this long was left by a writer that died mid-write
+#define DISKCACHE_STALE_TMP_SEC 60
+
+// File layout: header, source path (path_len bytes, no terminator), zero
+// padding up to data_offset, then width * height * 4 bytes of RGBA.
+// Integers are native-endian; the files never leave this machine.
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t data_offset;          // Start of the pixels
+    uint32_t width;
+    uint32_t height;
+    uint32_t path_len;
+    uint32_t reserved;
+    int64_t src_mtime_sec;         // Source file when it was decoded
+    int64_t src_mtime_nsec;
+    uint64_t src_size;
+    uint64_t checksum;             // Of the pixels
+} disk_header_t;
+
+// A mapped cache file, unmapped with the entry's last reference
+typedef struct {
+    void *addr;
+    size_t len;
+} mapped_file_t;
+
+// Background write of one entry
+typedef struct store_job {
+    char *path;
+    cache_entry_t *entry;
+    struct store_job *next;
+} store_job_t;
+
+// CHANGED 2026-10-16 - One writer thread with a bounded queue - Problem: a thread per store, each holding a
+// full-size image while it waited for the previous write, piled up under a burst of preloads
+static struct {
+    char *dir;                     // Cache directory, NULL when disabled
+    size_t max_size;               // Limit in bytes
+    pthread_mutex_t lock;          // Guards the queue and stopping
+    pthread_cond_t cond;           // Signals queued jobs and shutdown
+    store_job_t *head, *tail;
+    int queued;
+    pthread_t writer;              // Started by the first store
+    bool writer_running;
+    bool stopping;
+} disk = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+// FNV-1a
+static uint64_t hash_path(const char *path) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (const unsigned char *p = (const unsigned char *)path; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// FNV-1a over 64-bit words: cheap enough to run on every load (a few ms for 4K)
+static uint64_t checksum_pixels(const unsigned char *data, size_t len) {
+    uint64_t hash = 1469598103934665603ULL;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < len; i++)
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    return hash;
+}
+
+static size_t data_offset_for(size_t path_len) {
+    size_t offset = sizeof(disk_header_t) + path_len;
+    return (offset + DISKCACHE_ALIGN - 1) / DISKCACHE_ALIGN * DISKCACHE_ALIGN;
+}
+
+// One file per source path; a changed source overwrites its old file
+static bool cache_file_for(const char *path, char *buf, size_t buflen) {
+    int len = snprintf(buf, buflen, "%s/%016llx" DISKCACHE_SUFFIX,
+                       disk.dir, (unsigned long long)hash_path(path));
+    return len > 0 && (size_t)len < buflen;
+}
+
+// mkdir -p with mode 0700
+static bool make_dirs(const char *dir) {
+    char *path = strdup(dir);
+    if (!path)
+        return false;
+    for (char *p = path + 1; (p = strchr(p, '/')) != NULL; p++) {
+        *p = '\0';
+        if (mkdir(path, 0700) != 0 && errno != EEXIST) {
+            free(path);
+            return false;
+        }
+        *p = '/';
+    }
+    bool ok = mkdir(path, 0700) == 0 || errno == EEXIST;
+    free(path);
+    return ok;
+}
+
+static void release_mapped_file(void *owner) {
+    mapped_file_t *file = owner;
+    munmap(file->addr, file->len);
+    free(file);
+}
+
+// Returns NULL if the mapped file holds current pixels for path, else why not
+static const char *check_file(const unsigned char *map, size_t len, const char *path,
+                              const struct stat *src) {
+    disk_header_t header;
+    if (len < sizeof(header))
+        return "truncated";
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, DISKCACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DISKCACHE_VERSION)
+        return "unknown format";
+
+    size_t path_len = strlen(path);
+    size_t pixels = (size_t)header.width * header.height * 4;
+    if (header.path_len != path_len || header.data_offset != data_offset_for(path_len) ||
+        header.width == 0 || header.height == 0 || len != header.data_offset + pixels)
+        return "bad size";
+    if (memcmp(map + sizeof(header), path, path_len) != 0)
+        return "other path";
+    if (header.src_mtime_sec != (int64_t)src->st_mtim.tv_sec ||
+        header.src_mtime_nsec != (int64_t)src->st_mtim.tv_nsec ||
+        header.src_size != (uint64_t)src->st_size)
+        return "source changed";
+    if (checksum_pixels(map + header.data_offset, pixels) != header.checksum)
+        return "checksum mismatch";
+    return NULL;
+}
+
+static void prune(void);
+
+void diskcache_init(size_t max_size_mb) {
+    if (disk.dir || max_size_mb == 0)
+        return;
+
+    const char *xdg_cache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    char path[PATH_MAX];
+    int len = -1;
+    if (xdg_cache && xdg_cache[0] == '/')
+        len = snprintf(path, sizeof(path), "%s/gslapper", xdg_cache);
+    else if (home)
+        len = snprintf(path, sizeof(path), "%s/%s", home, DEFAULT_CACHE_DIR);
+    char *dir = len > 0 && (size_t)len < sizeof(path) ? strdup(path) : NULL;
+    if (!dir) {
+        cflp_warning("Disk cache disabled: no cache directory (set XDG_CACHE_HOME or HOME)");
+        return;
+    }
+    if (!make_dirs(dir)) {
+        cflp_warning("Disk cache disabled: cannot create %s: %s", dir, strerror(errno));
+        free(dir);
+        return;
+    }
+
+    disk.dir = dir;
+    disk.max_size = max_size_mb * 1024 * 1024;
+    disk.stopping = false;
+    cflp_info("Disk cache initialized: %s, %zu MB limit", dir, max_size_mb);
+
+    // The limit may have been lowered since the last run, and a crash may
+    // have left temp files behind (the writer isn't running yet)
+    prune();
+}
+
+static void free_job(store_job_t *job) {
+    cache_entry_unref(job->entry);
+    free(job->path);
+    free(job);
+}
+
+void diskcache_shutdown(void) {
+    if (!disk.dir)
+        return;
+
+    pthread_mutex_lock(&disk.lock);
+    disk.stopping = true;
+    store_job_t *dropped = disk.head;
+    disk.head = disk.tail = NULL;
+    disk.queued = 0;
+    pthread_cond_broadcast(&disk.cond);
+    bool running = disk.writer_running;
+    pthread_mutex_unlock(&disk.lock);
+
+    while (dropped) {
+        store_job_t *next = dropped->next;
+        free_job(dropped);
+        dropped = next;
+    }
+    if (running)
+        pthread_join(disk.writer, NULL);
+
+    pthread_mutex_lock(&disk.lock);
+    disk.writer_running = false;
+    disk.stopping = false;
+    pthread_mutex_unlock(&disk.lock);
+
+    free(disk.dir);
+    disk.dir = NULL;
+}
+
+bool diskcache_enabled(void) {
+    return disk.dir != NULL;
+}
+
+cache_entry_t *diskcache_load(const char *path) {
+    if (!disk.dir || !path)
+        return NULL;
+
+    struct stat src;
+    char file[PATH_MAX];
+    if (stat(path, &src) != 0 || !cache_file_for(path, file, sizeof(file)))
+        return NULL;
+
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return NULL;  // Not stored
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    const char *problem = map == MAP_FAILED ? "cannot map" :
+        check_file(map, st.st_size, path, &src);
+    if (problem) {
+        cflp_info("Disk cache dropped %s: %s", path, problem);
+        if (map != MAP_FAILED)
+            munmap(map, st.st_size);
+        close(fd);
+        unlink(file);
+        return NULL;
+    }
+
+    // Mark as recently used; pruning goes by file mtime
+    futimens(fd, NULL);
+    close(fd);
+
+    mapped_file_t *owner = malloc(sizeof(mapped_file_t));
+    if (!owner) {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+    owner->addr = map;
+    owner->len = st.st_size;
+
+    disk_header_t header;
+    memcpy(&header, map, sizeof(header));
+    const unsigned char *data = (const unsigned char *)map + header.data_offset;
+    cache_entry_t *entry = cache_enabled() ?
+        cache_add_external(path, data, header.width, header.height, release_mapped_file, owner) :
+        cache_entry_wrap(data, header.width, header.height, release_mapped_file, owner);
+
+    cflp_info("Disk cache hit: %s (%ux%u)", path, header.width, header.height);
+    return entry;
+}
+
+static bool write_all(int fd, const void *buf, size_t len) {
+    const unsigned char *p = buf;
+    while (len > 0) {
+        ssize_t written = write(fd, p, len);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        p += written;
+        len -= written;
+    }
+    return true;
+}
+
+// Write to a temp file and rename it over the old one, so a reader never
+// maps a half-written file. The pid keeps instances sharing the directory
+// (one per output) out of each other's temp files. Writer thread only.
+static void write_file(const char *path, const cache_entry_t *entry) {
+    struct stat src;
+    char file[PATH_MAX], tmp[PATH_MAX + 32];
+    if (stat(path, &src) != 0 || !cache_file_for(path, file, sizeof(file)))
+        return;
+    snprintf(tmp, sizeof(tmp), "%s.%d" DISKCACHE_TMP_SUFFIX, file, (int)getpid());
+
+    size_t path_len = strlen(path);
+    disk_header_t header = {
+        .magic = DISKCACHE_MAGIC,
+        .version = DISKCACHE_VERSION,
+        .data_offset = data_offset_for(path_len),
+        .width = entry->width,
+        .height = entry->height,
+        .path_len = path_len,
+        .src_mtime_sec = src.st_mtim.tv_sec,
+        .src_mtime_nsec = src.st_mtim.tv_nsec,
+        .src_size = src.st_size,
+        .checksum = checksum_pixels(entry->data, entry->size),
+    };
+    static const unsigned char padding[DISKCACHE_ALIGN];
+    size_t pad = header.data_offset - sizeof(header) - path_len;
+
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        cflp_warning("Disk cache: cannot create %s: %s", tmp, strerror(errno));
+        return;
+    }
+    bool ok = write_all(fd, &header, sizeof(header)) &&
+              write_all(fd, path, path_len) &&
+              write_all(fd, padding, pad) &&
+              write_all(fd, entry->data, entry->size);
+    if (close(fd) != 0)
+        ok = false;
+    if (!ok || rename(tmp, file) != 0) {
+        cflp_warning("Disk cache: failed to write %s: %s", file, strerror(errno));
+        unlink(tmp);
+        return;
+    }
+
+    cflp_info("Disk cache stored: %s (%.2f MB)", path,
+              (double)(header.data_offset + entry->size) / (1024 * 1024));
+}
+
+typedef struct {
+    char name[64];
+    struct timespec mtime;
+    size_t size;
+} disk_file_t;
+
+static int compare_mtime(const void *a, const void *b) {
+    const struct timespec *ta = &((const disk_file_t *)a)->mtime;
+    const struct timespec *tb = &((const disk_file_t *)b)->mtime;
+    if (ta->tv_sec != tb->tv_sec)
+        return ta->tv_sec < tb->tv_sec ? -1 : 1;
+    return ta->tv_nsec < tb->tv_nsec ? -1 : ta->tv_nsec > tb->tv_nsec;
+}
+
+static bool has_suffix(const char *name, size_t len, const char *suffix) {
+    size_t n = strlen(suffix);
+    return len > n && strcmp(name + len - n, suffix) == 0;
+}
+
+// Delete least recently used files until the directory fits the limit.
+// Temp files count towards it; those left by a dead writer are deleted.
+// Writer thread, or diskcache_init() before it starts.
+static void prune(void) {
+    DIR *dir = opendir(disk.dir);
+    if (!dir)
+        return;
+
+    disk_file_t *files = NULL;
+    size_t count = 0, capacity = 0, total = 0;
+    time_t now = time(NULL);
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        size_t len = strlen(de->d_name);
+        bool tmp = has_suffix(de->d_name, len, DISKCACHE_TMP_SUFFIX);
+        struct stat st;
+        if ((!tmp && !has_suffix(de->d_name, len, DISKCACHE_SUFFIX)) ||
+            len >= sizeof(files->name) ||
+            fstatat(dirfd(dir), de->d_name, &st, 0) != 0)
+            continue;
+        if (tmp) {
+            if (now - st.st_mtim.tv_sec > DISKCACHE_STALE_TMP_SEC &&
+                unlinkat(dirfd(dir), de->d_name, 0) == 0) {
+                cflp_info("Disk cache removed stale %s", de->d_name);
+            } else {
+                total += st.st_size;  // Being written, possibly by another instance
+            }
+            continue;
+        }
+        if (count == capacity) {
+            size_t grown = capacity ? capacity * 2 : 32;
+            disk_file_t *resized = realloc(files, grown * sizeof(*files));
+            if (!resized)
+                break;
+            files = resized;
+            capacity = grown;
+        }
+        memcpy(files[count].name, de->d_name, len + 1);
+        files[count].mtime = st.st_mtim;
+        files[count].size = st.st_size;
+        total += st.st_size;
+        count++;
+    }
+
+    if (total > disk.max_size) {
+        qsort(files, count, sizeof(*files), compare_mtime);
+        for (size_t i = 0; i < count && total > disk.max_size; i++) {
+            if (unlinkat(dirfd(dir), files[i].name, 0) == 0) {
+                total -= files[i].size;
+                cflp_info("Disk cache evicted (LRU): %s (%.2f MB)", files[i].name,
+                          (double)files[i].size / (1024 * 1024));
+            }
+        }
+    }
+
+    free(files);
+    closedir(dir);
+}
+
+static void *writer_main(void *data) {
+    (void)data;
+
+    pthread_mutex_lock(&disk.lock);
+    while (!disk.stopping) {
+        if (!disk.head) {
+            pthread_cond_wait(&disk.cond, &disk.lock);
+            continue;
+        }
+
+        store_job_t *job = disk.head;
+        disk.head = job->next;
+        if (!disk.head)
+            disk.tail = NULL;
+        disk.queued--;
+        pthread_mutex_unlock(&disk.lock);
+
+        write_file(job->path, job->entry);
+        prune();
+        free_job(job);
+
+        pthread_mutex_lock(&disk.lock);
+    }
+    pthread_mutex_unlock(&disk.lock);
+    return NULL;
+}
+
+void diskcache_store(const char *path, cache_entry_t *entry) {
+    if (!disk.dir || !path || !entry)
+        return;
+    if (data_offset_for(strlen(path)) + entry->size > disk.max_size)
+        return;  // Would be pruned straight away
+
+    pthread_mutex_lock(&disk.lock);
+
+    // A queued write of the same path takes the newer pixels
+    for (store_job_t *job = disk.head; job; job = job->next) {
+        if (strcmp(job->path, path) == 0) {
+            cache_entry_t *old = job->entry;
+            job->entry = cache_entry_ref(entry);
+            pthread_mutex_unlock(&disk.lock);
+            cache_entry_unref(old);
+            return;
+        }
+    }
+    if (disk.stopping || disk.queued >= DISKCACHE_QUEUE_MAX) {
+        pthread_mutex_unlock(&disk.lock);
+        cflp_info("Disk cache: write queue full, not storing %s", path);
+        return;
+    }
+
+    store_job_t *job = calloc(1, sizeof(store_job_t));
+    if (!job || !(job->path = strdup(path))) {
+        free(job);
+        pthread_mutex_unlock(&disk.lock);
+        return;
+    }
+    if (!disk.writer_running) {
+        disk.writer_running = pthread_create(&disk.writer, NULL, writer_main, NULL) == 0;
+        if (!disk.writer_running) {
+            pthread_mutex_unlock(&disk.lock);
+            cflp_error("Disk cache: failed to start writer thread");
+            free(job->path);
+            free(job);
+            return;
+        }
+    }
+    job->entry = cache_entry_ref(entry);
+
+    if (disk.tail)
+        disk.tail->next = job;
+    else
+        disk.head = job;
+    disk.tail = job;
+    disk.queued++;
+    pthread_cond_signal(&disk.cond);
+    pthread_mutex_unlock(&disk.lock);
+}
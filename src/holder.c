@@ -10,6 +10,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "procmon.h"
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
 #include <wayland-client.h>
 
@@ -80,14 +81,10 @@ static void revive_slapper() {
 
 static void check_stoplist() {
 
-    char pid_name[512] = {0};
+    // Wait until every stoplist program has exited
+    while (procmon_scan(halt_info.stoplist, NULL))
+        usleep(100000); // 0.1 sec
 
-    for (uint i=0; halt_info.stoplist[i] != NULL; i++) {
-        snprintf(pid_name, sizeof(pid_name), "pidof %s > /dev/null", halt_info.stoplist[i]);
-
-        while (!system(pid_name))
-            usleep(100000); // 0.1 sec
-    }
     if (!halt_info.auto_stop)
         revive_slapper();
 }
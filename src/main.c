@@ -17,11 +17,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <time.h>
 #include <unistd.h>
 
 #include "wlr-layer-shell-unstable-v1-client-protocol.h"
+#include "presentation-time-client-protocol.h"
+#ifdef HAVE_EXT_IDLE_NOTIFY
+#include "ext-idle-notify-v1-client-protocol.h"
+#endif
 #include <wayland-client.h>
 #include <wayland-egl.h>
 
@@ -33,11 +39,16 @@
 #include <gst/video/video.h>
 #include <gst/video/videooverlay.h>
 #include <gst/gl/gl.h>
+#include <gst/gl/egl/gstgldisplay_egl.h>
+#include <gst/allocators/allocators.h>
 
 #include <cflogprinter.h>
 #include "ipc.h"
 #include "state.h"
 #include "cache.h"
+#include "preload.h"
+#include "diskcache.h"
+#include "procmon.h"
 
 #ifdef HAVE_SYSTEMD
 #include <systemd/sd-daemon.h>
@@ -45,10 +56,52 @@
 
 typedef unsigned int uint;
 
+// EGL_EXT_image_dma_buf_import tokens (glad only generates EGL core + platform_wayland)
+#ifndef EGL_LINUX_DMA_BUF_EXT
+#define EGL_LINUX_DMA_BUF_EXT             0x3270
+#define EGL_LINUX_DRM_FOURCC_EXT          0x3271
+#define EGL_DMA_BUF_PLANE0_FD_EXT         0x3272
+#define EGL_DMA_BUF_PLANE0_OFFSET_EXT     0x3273
+#define EGL_DMA_BUF_PLANE0_PITCH_EXT      0x3274
+#endif
+#ifndef EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT
+#define EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT 0x3443
+#define EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT 0x3444
+#endif
+
+// DRM_FORMAT_ABGR8888 ('AB24'): R, G, B, A bytes in memory, i.e. GStreamer RGBA
+#define DRM_FOURCC_ABGR8888 0x34324241
+#define DRM_MODIFIER_INVALID 0x00ffffffffffffffULL
+
+typedef EGLImageKHR (*egl_create_image_khr_fn)(EGLDisplay dpy, EGLContext ctx, EGLenum target,
+                                               EGLClientBuffer buffer, const EGLint *attrib_list);
+typedef EGLBoolean (*egl_destroy_image_khr_fn)(EGLDisplay dpy, EGLImageKHR image);
+typedef void (*gl_egl_image_target_texture_2d_fn)(GLenum target, void *image);
+
+// EGL_KHR_fence_sync / EGL_KHR_wait_sync, for --threaded-render
+#ifndef EGL_SYNC_FENCE_KHR
+#define EGL_SYNC_FENCE_KHR                0x30F9
+#define EGL_SYNC_FLUSH_COMMANDS_BIT_KHR   0x0001
+#endif
+
+typedef EGLSyncKHR (*egl_create_sync_khr_fn)(EGLDisplay dpy, EGLenum type, const EGLint *attrib_list);
+typedef EGLBoolean (*egl_destroy_sync_khr_fn)(EGLDisplay dpy, EGLSyncKHR sync);
+typedef EGLint (*egl_client_wait_sync_khr_fn)(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout);
+typedef EGLint (*egl_wait_sync_khr_fn)(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags);
+
+// EGL_KHR_swap_buffers_with_damage / EGL_EXT_swap_buffers_with_damage
+typedef EGLBoolean (*egl_swap_buffers_with_damage_fn)(EGLDisplay dpy, EGLSurface surface,
+                                                      const EGLint *rects, EGLint n_rects);
+
 struct wl_state {
     struct wl_display *display;
     struct wl_compositor *compositor;
     struct zwlr_layer_shell_v1 *layer_shell;
+    struct wp_presentation *presentation; // optional, drives frame pacing
+    struct wl_seat *seat;                 // first seat, for --idle-pause
+#ifdef HAVE_EXT_IDLE_NOTIFY
+    struct ext_idle_notifier_v1 *idle_notifier;
+#endif
     struct wl_list outputs; // struct display_output::link
     char *monitor; // User selected output
     int surface_layer;
@@ -73,6 +126,15 @@ struct display_output {
 
     struct wl_callback *frame_callback;
     bool redraw_needed;
+
+    struct render_thread *render_thread;  // --threaded-render, NULL while drawn from the main loop
+    uint64_t presented_generation;        // frame_generation last swapped to this output
+    float quad_scale_x, quad_scale_y;     // video quad size from the last update_quad_vertices()
+    EGLint damage_rect[4];                // video rect of the last swap (x, y, w, h; bottom-left origin)
+    int64_t present_ns;                   // wp_presentation: when the last frame hit the screen
+    int64_t refresh_ns;                   // wp_presentation: refresh interval, 0 if unknown/variable
+    int32_t refresh_mhz;                  // wl_output current mode refresh, 0 if unknown
+    int64_t frame_request_ns;             // video frame callback pending since, 0 = none (visibility.lock)
 };
 
 // GStreamer elements
@@ -85,14 +147,21 @@ static bool using_waylandsink = false;
 
 // Video texture information
 static GLuint video_texture = 0;
-static GLuint shader_program = 0;
 static GLuint transition_shader_program = 0;  // Shader for transitions
 static GLuint vao = 0, vbo = 0;
 static pthread_mutex_t video_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+// Pixel layout of a decoded frame. Images and the cache are always RGBA.
+typedef enum {
+    FRAME_FORMAT_RGBA = 0,
+    FRAME_FORMAT_NV12,         // Y plane + interleaved half-size UV plane
+    FRAME_FORMAT_I420,         // Y, U, V planes, chroma at half size
+    FRAME_FORMAT_UNSUPPORTED
+} frame_format_t;
+
 // Smart texture management to reduce reallocations
 static struct {
-    GLuint texture;
+    GLuint texture;            // RGBA frame, or the Y plane for YUV formats
     int current_width;
     int current_height;
     gboolean initialized;
@@ -100,8 +169,120 @@ static struct {
     GLuint pbo[2];
     int pbo_index;
     gboolean pbo_disabled; // fall back to direct uploads permanently on failure
+    // CHANGED 2026-10-16 - Texture storage can be an imported DMA-BUF - Problem: mapping + re-uploading every decoded frame cost ~2 GB/s of memcpy at 4K60
+    EGLImageKHR egl_image;     // non-NULL while texture is backed by an imported DMA-BUF
+    GstBuffer *dmabuf_buffer;  // keeps the imported DMA-BUF alive while the texture samples it
+    // CHANGED 2026-10-16 - Planar YUV storage + shader-side conversion - Problem: videoconvert to RGBA was the heaviest CPU stage and uploaded 4 bytes/pixel instead of 1.5
+    frame_format_t format;
+    GLuint chroma[2];          // NV12: UV in chroma[0]; I420: U, V
+    GstVideoColorMatrix color_matrix;
+    GstVideoColorRange color_range;
+    GLfloat yuv_matrix[9];     // column-major YCbCr -> RGB for the current colorimetry
+    GLfloat yuv_offset[3];
+    // CHANGED 2026-10-16 - Sample GstGLMemory textures directly - Problem: --upload gl frames never leave the GPU
+    GstBuffer *gl_buffer;      // GL-mapped frame whose texture is displayed, NULL otherwise
+    GstMapInfo gl_map;
+    GLuint gl_texture;         // texture id from gl_buffer (shared context)
+    // CHANGED 2026-10-16 - Compressed cache hits upload their blocks as is - Problem: see --cache-compress
+    gboolean compressed;       // storage came from glCompressedTexImage2D; respecify before other uploads
 } texture_manager = {0};
 
+// Video upload path selected with --upload
+typedef enum {
+    UPLOAD_MODE_COPY = 0,  // map decoded frames and upload them (glTexSubImage2D / PBO)
+    UPLOAD_MODE_DMABUF,    // import DMA-BUF frames as EGLImages, mapped upload as fallback
+    UPLOAD_MODE_GL         // glupload into GstGLMemory on a context shared with ours
+} upload_mode_t;
+
+static upload_mode_t upload_mode = UPLOAD_MODE_COPY;
+
+// DMA-BUF import entry points, resolved in init_egl() when the driver supports them
+static struct {
+    gboolean supported;
+    gboolean modifiers;  // EGL_EXT_image_dma_buf_import_modifiers
+    egl_create_image_khr_fn create_image;
+    egl_destroy_image_khr_fn destroy_image;
+    gl_egl_image_target_texture_2d_fn image_target_texture;
+} egl_dmabuf = {0};
+
+static inline bool dmabuf_upload_active(void) {
+    return upload_mode == UPLOAD_MODE_DMABUF && egl_dmabuf.supported;
+}
+
+// What a draw pass needs from texture_manager. Render threads get a copy so
+// they never read texture_manager while the main thread uploads.
+struct render_frame {
+    GLuint texture;
+    GLuint chroma[2];
+    frame_format_t format;
+    int width, height;
+    GLfloat yuv_matrix[9];
+    GLfloat yuv_offset[3];
+    uint64_t generation;  // frame_generation of the upload
+};
+
+// CHANGED 2026-10-16 - One frame shader per context that draws - Problem: render threads set uniforms on
+// the main program at the same time; uniform values live in the program object, which every shared
+// context sees, so one output could draw with another's values
+// A linked frame shader with the uniform locations draw_render_frame() sets
+struct frame_shader {
+    GLuint program;
+    GLint yuv_mode;
+    GLint yuv_to_rgb;
+    GLint yuv_offset;
+};
+static struct frame_shader frame_shader = {0};  // Main loop's, created by ensure_shader_program()
+
+// CHANGED 2026-10-16 - Optional per-output render threads - Problem: outputs were drawn and swapped
+// in series on the main thread, so one slow swap delayed every other monitor
+struct render_thread {
+    struct display_output *output;
+    pthread_t thread;
+    EGLContext context;                 // shares objects with egl_context
+    struct wl_event_queue *queue;       // frame callbacks for this output only
+    struct wl_surface *surface_wrapper; // output->surface proxy on queue
+    int stop_fd;                        // eventfd, wakes the thread out of poll()
+    bool frame_done;                    // set by this output's frame callback
+    // Guarded by render_threads.lock
+    bool stop;
+    bool drawing;                       // sampling shared textures right now
+    EGLSyncKHR draw_fence;              // signalled once the last draw stopped sampling them
+};
+
+// Main thread uploads each decoded frame once and publishes it; every
+// output thread draws the newest published frame at its own pace.
+static struct {
+    bool enabled;                       // --threaded-render
+    EGLint context_attrib[7];           // attributes egl_context was created with
+    bool fence_sync;                    // EGL_KHR_fence_sync + EGL_KHR_wait_sync
+    egl_create_sync_khr_fn create_sync;
+    egl_destroy_sync_khr_fn destroy_sync;
+    egl_client_wait_sync_khr_fn client_wait_sync;
+    egl_wait_sync_khr_fn wait_sync;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;                // frame published, draw finished or stop requested
+    bool uploading;                     // texture_manager is being rewritten
+    uint64_t generation;                // bumped for every published frame
+    struct render_frame frame;
+    EGLSyncKHR upload_fence;            // signalled when frame's upload completed
+} render_threads = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+// GStreamer view of our EGL display/context for --upload gl. GStreamer's GL
+// elements create their own context shared with app_context, so texture ids
+// in GstGLMemory are valid on our context.
+static struct {
+    GstGLDisplay *display;
+    GstGLContext *app_context;  // wraps egl_context
+} gst_gl = {0};
+
+static inline bool gl_upload_active(void) {
+    return upload_mode == UPLOAD_MODE_GL && gst_gl.app_context != NULL;
+}
+
 // Video frame data for thread-safe texture updates
 static struct {
     gboolean has_new_frame;
@@ -112,12 +293,38 @@ static struct {
     // CHANGED 2026-07-08 - Hold a mapped GstBuffer ref instead of a heap copy - Problem: g_memdup2 copied every frame (~14-33MB) on the hot path
     GstBuffer *buffer;   // non-NULL when data borrows from a mapped GStreamer buffer
     GstMapInfo map;      // valid while buffer is non-NULL
+    // CHANGED 2026-10-16 - Cache hits borrow the entry's pixels - Problem: every hit copied the whole image
+    cache_entry_t *cache_entry; // non-NULL when data borrows from a cache entry (holds a reference)
+    GLenum compressed_format;   // non-zero when data holds compressed texture blocks (cache hits)
+    // DMA-BUF frames keep the buffer ref but are never mapped (data/map unused)
+    gboolean is_dmabuf;
+    int dmabuf_fd;
+    gsize dmabuf_offset;
+    gint dmabuf_stride;
+    guint64 dmabuf_modifier;
+    // GstGLMemory frames keep buffer/map (GST_MAP_GL); data is unused
+    gboolean is_glmemory;
+    guint gl_texture;
+    // Layout of mapped frames; stride 0 means tightly packed rows
+    frame_format_t format;
+    gsize plane_offset[3];
+    gint plane_stride[3];
+    GstVideoColorMatrix color_matrix;
+    GstVideoColorRange color_range;
+    gboolean loop_start;  // a frame since the last upload restarted the video (PTS went back)
 } video_frame_data = {0};
 
 // CHANGED 2026-07-09 - Caps cache moved to file scope so shutdown can release the held ref - Problem: function-static cached_caps leaked one GstCaps ref at exit
 // Only touched by the GStreamer streaming thread (buffer_probe), plus exit_cleanup after pipeline teardown.
 static GstCaps *cached_caps = NULL;
-static gboolean cached_is_rgba = FALSE;
+// Last admitted video PTS, for spotting loop points; streaming thread only (reset while in READY)
+static GstClockTime probe_last_pts = GST_CLOCK_TIME_NONE;
+static frame_format_t cached_format = FRAME_FORMAT_UNSUPPORTED;
+static GstVideoInfo cached_info;  // plane layout + colorimetry, valid when cached_info_valid
+static gboolean cached_info_valid = FALSE;
+static gboolean cached_is_dmabuf = FALSE;
+static gboolean cached_is_glmemory = FALSE;
+static guint64 cached_drm_modifier = DRM_MODIFIER_INVALID;
 static gint cached_width = 0, cached_height = 0;
 
 static void release_cached_caps(void) {
@@ -125,7 +332,11 @@ static void release_cached_caps(void) {
         gst_caps_unref(cached_caps);
         cached_caps = NULL;
     }
-    cached_is_rgba = FALSE;
+    cached_format = FRAME_FORMAT_UNSUPPORTED;
+    cached_info_valid = FALSE;
+    cached_is_dmabuf = FALSE;
+    cached_is_glmemory = FALSE;
+    cached_drm_modifier = DRM_MODIFIER_INVALID;
     cached_width = 0;
     cached_height = 0;
 }
@@ -134,13 +345,24 @@ static void release_cached_caps(void) {
 // Caller must hold video_mutex.
 static void release_video_frame_locked(void) {
     if (video_frame_data.buffer) {
-        gst_buffer_unmap(video_frame_data.buffer, &video_frame_data.map);
+        if (!video_frame_data.is_dmabuf)
+            gst_buffer_unmap(video_frame_data.buffer, &video_frame_data.map);
         gst_buffer_unref(video_frame_data.buffer);
         video_frame_data.buffer = NULL;
+    } else if (video_frame_data.cache_entry) {
+        cache_entry_unref(video_frame_data.cache_entry);
+        video_frame_data.cache_entry = NULL;
     } else if (video_frame_data.data) {
         g_free(video_frame_data.data);
     }
     video_frame_data.data = NULL;
+    video_frame_data.is_dmabuf = FALSE;
+    video_frame_data.is_glmemory = FALSE;
+    video_frame_data.compressed_format = 0;
+    // Back to the RGBA default used by images and cache hits
+    video_frame_data.format = FRAME_FORMAT_RGBA;
+    memset(video_frame_data.plane_offset, 0, sizeof(video_frame_data.plane_offset));
+    memset(video_frame_data.plane_stride, 0, sizeof(video_frame_data.plane_stride));
     video_frame_data.has_new_frame = FALSE;
 }
 
@@ -148,25 +370,139 @@ static struct wl_state *global_state = NULL;
 
 // Frame rate limiting for GPU optimization
 static struct timespec last_render_time = {0};
-static long long target_frame_time_ns = 33333333; // Default ~30 FPS (1/30 * 1e9)
-static int frame_rate_cap = 30; // Default 30 FPS
+// CHANGED 2026-10-16 - Any integer cap plus "auto", enforced on stream time in buffer_probe - Problem: only
+// 30/60/100 were accepted and the cap merely throttled redraws; every decoded frame was still uploaded
+#define FRAME_RATE_AUTO 0 // --fps-cap auto: content framerate, clamped to the fastest output's refresh
+#define FRAME_RATE_CAP_MAX 1000
+static long long target_frame_time_ns = 33333333; // Minimum stream-time spacing of shown frames, 0 = all frames
+static int frame_rate_cap = 30; // Default 30 FPS, or FRAME_RATE_AUTO
+static int content_fps_num = 0, content_fps_den = 1; // From negotiated caps, 0 = unknown/variable
+static int fastest_refresh_mhz = 0; // Highest current mode refresh among outputs, 0 = unknown
+static GstClockTime next_frame_slot = GST_CLOCK_TIME_NONE; // Running time the next shown frame is due
 static int frames_skipped = 0; // Track skipped frames for adaptive skipping
+static uint64_t frame_generation = 0; // Bumped each time a decoded frame reaches texture_manager
+
+// CHANGED 2026-10-16 - Presentation counters for the IPC stats command - Problem: no way to see
+// how many swaps the generation check and partial damage actually save
+static struct {
+    pthread_mutex_t lock;
+    uint64_t uploads;        // decoded frames moved into texture_manager
+    uint64_t swaps;          // buffers presented
+    uint64_t swaps_skipped;  // draws skipped because the output already showed the frame
+    uint64_t partial_swaps;  // swaps that damaged only the video rect
+    uint64_t decoded;        // frames out of the decoder, before videorate
+    uint64_t converted;      // frames converted and delivered to appsink
+    uint64_t capped;         // frames dropped at appsink by the cap or a flush
+    uint64_t suspends;       // times playback was suspended because nothing was visible
+    int64_t resume_ns;       // last time from becoming visible to a new frame on screen
+    uint64_t loops;          // times the video restarted from the beginning
+    int64_t loop_gap_ns;     // time between the last upload of a loop and the first of the next
+    int64_t frame_gap_ns;    // smoothed time between uploads within a loop
+    uint64_t transition_frames;   // transition draws timed during the last transition
+    int64_t transition_total_ns;  // their GPU time (GL_TIME_ELAPSED)
+    int64_t transition_max_ns;    // the slowest of them
+} render_stats = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+// GPU timer for transition draws: one query in flight, read once the result
+// is available so the main loop never waits on the GPU for it
+static struct {
+    GLuint query;
+    bool pending;
+} transition_timer = {0};
+
+static egl_swap_buffers_with_damage_fn egl_swap_with_damage = NULL;
+
+// Render threads count too, so go through the lock
+static void count_render_stat(uint64_t *counter) {
+    pthread_mutex_lock(&render_stats.lock);
+    (*counter)++;
+    pthread_mutex_unlock(&render_stats.lock);
+}
+
+// Time between two uploads; the one that starts a new loop is kept apart so
+// the loop point can be compared with the usual frame interval
+static void record_upload_interval(int64_t interval_ns, bool loop_start) {
+    pthread_mutex_lock(&render_stats.lock);
+    if (loop_start) {
+        render_stats.loops++;
+        render_stats.loop_gap_ns = interval_ns;
+    } else if (interval_ns < 1000000000LL) {
+        // Pauses and stalls longer than a second say nothing about frame pacing
+        render_stats.frame_gap_ns = render_stats.frame_gap_ns ?
+            (render_stats.frame_gap_ns * 7 + interval_ns) / 8 : interval_ns;
+    }
+    pthread_mutex_unlock(&render_stats.lock);
+}
+
+// CHANGED 2026-10-16 - Vblank grid from wp_presentation feedback, read by buffer_probe - Problem: frames were
+// handed over whenever the streaming thread got to them, so which vblank showed a frame was left to chance
+// and 24 fps content on 120/144 Hz panels alternated between too-short and too-long holds
+#define FRAME_PACING_MAX_WAIT_NS 100000000LL  // never hold the streaming thread longer than this
+#define FRAME_PACING_MARGIN_NS     1000000LL  // deliver this long after the preceding vblank
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool flushing;            // flush in progress, drop whatever we are holding
+    bool clock_monotonic;     // compositor timestamps are CLOCK_MONOTONIC
+    uint32_t output_name;     // wl_name of the output the grid comes from (fastest refresh wins)
+    int64_t last_present_ns;  // last presentation time on that output
+    int64_t refresh_ns;       // its refresh interval, 0 = unknown or variable
+} frame_pacing = { .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER };
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
 static char *video_path;
 static char *gst_options = "";
 static float panscan_value = 1.0f;  // Default to full size (no scaling)
 static bool stretch_mode = false;  // Stretch to fill without maintaining aspect ratio
 static bool fill_mode = false;       // Fill screen maintaining aspect ratio (crops excess)
+static bool fill_mode_defaulted = false;  // fill_mode was turned on because the wallpaper is an image
 static bool is_image_mode = false;   // True if displaying static image vs video
+static bool gapless_loop = false;    // -o loop=gapless: loop by queueing the file again on a second decoder
+static bool loop_segment_initialized = false;  // Initial segment seek done for the current file
+static int64_t video_switch_ns = 0;  // When an in-process video switch started, 0 once its first frame is up
 static gint64 gif_loop_start_us = 0; // Monotonic time the current GIF loop iteration started
 // CHANGED 2026-07-20 - Snapshot GIF-ness and expose a shutdown flag to the events thread - Problem:
 // the GStreamer events thread runs with cancellation disabled, so exit_cleanup's pthread_cancel never
 // stops it. It must not read video_path (freed by exit_cleanup) or sleep/seek against a pipeline being
-// torn down. video_is_gif is set once at startup (video changes restart the process, so it never goes
-// stale); shutting_down tells the events thread to stop touching the pipeline.
+// torn down. video_is_gif is set at startup and by in-process changes while the streaming threads are
+// stopped; shutting_down tells the events thread to stop touching the pipeline.
 static bool video_is_gif = false;    // True when the wallpaper is a GIF playing via the video pipeline
 static volatile sig_atomic_t shutting_down = 0;
 static bool image_frame_captured = false;  // True once image frame is decoded
 
+// CHANGED 2026-10-16 - Image changes complete from the main loop - Problem: reload_image_pipeline() polled
+// for the decoded frame for up to 5 s, stalling Wayland, IPC and the running transition
+// Image change still decoding on the image pipeline's streaming thread. The
+// buffer probe posts the frame and wakes the main loop, which finishes the
+// change in poll_image_load(); errors and the timeout end it in image_load_failed().
+#define IMAGE_LOAD_TIMEOUT_MS 5000
+static struct {
+    bool active;
+    int client_fd;                      // IPC client waiting for the result, -1 when answered
+    int timer_fd;                       // IMAGE_LOAD_TIMEOUT_MS one-shot
+    char resolved_path[PATH_MAX];
+    char old_resolved_path[PATH_MAX];   // Previous image, no longer displayed in the cache
+} image_load = { .client_fd = -1, .timer_fd = -1 };
+
+// CHANGED 2026-10-16 - Video changes complete from the bus - Problem: a video that failed to
+// decode after an in-process change reached bus_callback's exit, so a bad file took gSlapper down
+// Video change waiting for the new file to reach PAUSED. dispatch_bus_messages()
+// finishes it in video_switch_done(), or puts back the wallpaper it replaced in
+// video_switch_failed() when the file turns out to be unplayable.
+static struct {
+    bool active;
+    int client_fd;          // IPC client waiting for the result, -1 when answered
+    char *old_path;         // Wallpaper to go back to, the last one known to play
+    char *old_uri;          // Its playbin uri, NULL when it was an image
+    double old_position;    // Seconds into the old video
+    GstState old_state;     // PLAYING, or PAUSED while a pause hold applied
+} video_switch = { .client_fd = -1 };
+
 // State management for systemd service
 static char *state_file_path = NULL;
 static bool systemd_mode = false;
@@ -189,6 +525,15 @@ static bool ipc_paused = false;
 
 // Cache configuration
 static size_t cache_size_mb = DEFAULT_CACHE_SIZE_MB;
+static size_t disk_cache_mb = 0;  // --disk-cache, 0 = off
+static cache_compress_t cache_compress_mode = CACHE_COMPRESS_OFF;
+// Compressed texture format cached images are transcoded to (--cache-compress auto), 0 = none.
+// Chosen in init_egl(); afterwards read and cleared under gpu_encoder.lock
+static GLenum cache_gpu_format = 0;
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
 
 // Transition effects
 typedef enum {
@@ -203,8 +548,10 @@ typedef struct {
     float duration;
     float elapsed;
     float progress;
-    GLuint old_texture;
+    GLuint old_texture;            // RGBA copy of the outgoing frame
     GLuint new_texture;
+    GLuint old_vao, old_vbo;       // Quad for the outgoing frame's own aspect ratio
+    bool awaiting_frame;           // Fade starts once the new wallpaper's first frame is uploaded
     int old_width, old_height;
     int new_width, new_height;
     float old_scale_x, old_scale_y;
@@ -222,6 +569,9 @@ static transition_state_t transition_state = {
     .progress = 0.0f,
     .old_texture = 0,
     .new_texture = 0,
+    .old_vao = 0,
+    .old_vbo = 0,
+    .awaiting_frame = false,
     .old_width = 0,
     .old_height = 0,
     .new_width = 0,
@@ -233,11 +583,66 @@ static transition_state_t transition_state = {
     .start_time = {0}
 };
 
+// Fade anyway if the new wallpaper has not produced a frame by then
+#define TRANSITION_FRAME_TIMEOUT_S 2.0f
+
 static EGLConfig egl_config;
 static EGLDisplay *egl_display;
 static EGLContext *egl_context;
 
-static int wakeup_pipe[2];
+// eventfd the main loop polls; written when a frame is ready, on visibility changes and on signals
+static int wakeup_fd = -1;
+
+// Video decoder preference selected with --decoder / set-decoder
+typedef enum {
+    DECODER_AUTO = 0,  // plugin ranks as installed
+    DECODER_HW,        // prefer hardware decoders, fall back to software
+    DECODER_HW_ONLY,   // hardware decoders only
+    DECODER_SW         // software decoders only
+} decoder_policy_t;
+
+static decoder_policy_t decoder_policy = DECODER_AUTO;
+
+// Decoder playbin actually plugged, set from the streaming thread
+static pthread_mutex_t decoder_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char active_decoder[64] = "";
+static bool active_decoder_is_hw = false;
+
+// CHANGED 2026-10-16 - set-decoder finishes from the bus - Problem: replug_video_decoder() blocked the main
+// loop for up to 5 s waiting for the new decoder to preroll, and a failure left the new ranks applied
+// and the pipeline in READY
+// Decoder change waiting for the pipeline to preroll with the new ranks. bus_callback() finishes it on
+// ASYNC_DONE, or on an error puts the previous policy back and replugs again. Guarded by decoder_mutex.
+static struct {
+    bool active;
+    bool restoring;                     // Replugging with previous_policy after a failure
+    int client_fd;                      // IPC client waiting for the result, -1 when answered
+    decoder_policy_t previous_policy;
+    gint64 position;                    // Where to resume once prerolled, -1 if unknown
+} decoder_replug = { .client_fd = -1 };
+
+// CHANGED 2026-10-16 - Optional in-pipeline downscale to output size - Problem: a 4K source on a
+// 1080p panel was converted and uploaded at 4K every frame, then shrunk by the GPU
+#define DECODE_FILTER_MAX_OUTPUTS 16
+
+static bool decode_scale_enabled = false;
+
+// playbin video-filter state. Output sizes are snapshotted by the main
+// thread; source caps arrive on the streaming thread.
+static struct {
+    pthread_mutex_t lock;
+    GstElement *rate;        // ref'd drop-only videorate, NULL when not installed
+    uint64_t rate_dropped;   // drops counted by videorates of earlier pipelines
+    GstElement *crop;        // ref'd videocrop, NULL when the filter is not installed
+    GstElement *scale_caps;  // ref'd capsfilter after videoscale
+    int source_width, source_height;
+    int crop_x, crop_y;      // pixels removed from each side
+    int target_width, target_height;
+    int n_outputs;
+    int output_width[DECODE_FILTER_MAX_OUTPUTS];   // logical size, as in update_vertex_data()
+    int output_height[DECODE_FILTER_MAX_OUTPUTS];
+    int output_scale[DECODE_FILTER_MAX_OUTPUTS];
+} decode_filter = { .lock = PTHREAD_MUTEX_INITIALIZER };
 
 // State management
 static struct {
@@ -257,7 +662,22 @@ static struct {
 
 } halt_info = {NULL, NULL, 0, NULL, NULL, 0, 0, 0, 0, 0};
 
-static pthread_t threads[5] = {0};
+// CHANGED 2026-10-16 - Event-driven visibility replaces the 2 s auto-pause poll - Problem: handle_auto_pause()
+// noticed a hidden wallpaper up to 4 s late and spun on a 10 ms sleep until it was shown again
+// An output is hidden when the frame callback committed with its last video frame goes
+// unanswered; compositors stop sending them for occluded or powered-off outputs. The
+// main loop suspends playback once every output is hidden (or the seat went idle, with
+// --idle-pause) and resumes it from the first callback that comes back.
+static struct {
+    pthread_mutex_t lock;
+    bool suspended;            // holds one halt_info.is_paused count, pipeline PAUSED
+    bool idle;                 // ext-idle-notify: no input for --idle-pause seconds
+    bool wake;                 // a starved frame callback arrived while suspended
+    int64_t wake_ns;           // when that callback arrived
+    bool measuring;            // waiting for the first new frame after resuming
+    uint64_t wake_generation;  // frame_generation when playback resumed
+    uint32_t idle_timeout_ms;  // --idle-pause, 0 = off
+} visibility = { .lock = PTHREAD_MUTEX_INITIALIZER };
 
 static uint SLIDESHOW_TIME = 0;
 static bool SHOW_OUTPUTS = false;
@@ -268,10 +688,11 @@ static char *ipc_socket_path = NULL;
 static void exit_cleanup();
 static void exit_slapper(int reason);
 static void handle_signal(int signum);
+static bool wake_main_loop(void);
 static void render(struct display_output *output);
+static void stop_all_render_threads(void);
 static void stop_slapper();
 static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer data);
-static void *handle_gst_events(void *);
 static void init_texture_manager();
 static void cleanup_texture_manager();
 static GLuint get_texture_for_dimensions(int width, int height);
@@ -281,26 +702,59 @@ static bool is_image_file(const char *path);
 static bool is_gif_file(const char *path);
 static bool is_static_image_path(const char *path);
 static bool should_use_transition(const char *new_path);
+static bool parse_decoder_policy(const char *name, int *policy);
+static bool apply_decoder_policy(int policy);
+static const char *decoder_policy_name(int policy);
+static void replug_video_decoder(int previous_policy, int client_fd);
+static void decoder_replug_done(void);
+static bool decoder_replug_failed(void);
+static bool parse_frame_rate_cap(const char *arg, int *fps);
+static double effective_frame_rate_locked(void);
+static void set_frame_rate_cap(int fps);
+static void apply_frame_rate_filter(void);
+static void set_content_frame_rate(int num, int den);
+static void refresh_fastest_output_rate(struct wl_state *state);
+static bool frame_rate_admits(GstClockTime running_time);
+static uint64_t decode_rate_dropped(void);
 static void start_transition(const char *new_path);
 static void update_transition(void);
 static void render_transition(struct display_output *output);
 static void complete_transition(void);
 static void cancel_transition(void);
+static void transition_frame_arrived(void);
+static bool ensure_shader_program(void);
+static void create_quad_buffers(GLuint *quad_vao, GLuint *quad_vbo);
+static void update_quad_vertices(struct display_output *output, GLuint quad_vbo, int vid_width, int vid_height);
+static void update_vertex_data(struct display_output *output);
+static void snapshot_render_frame(struct render_frame *frame);
+static void draw_render_frame(const struct render_frame *frame, const struct frame_shader *shader, GLuint quad_vao);
 static void init_image_pipeline(void);
 static bool reload_image_pipeline(const char *new_path);
+static void poll_image_load(void);
+static void answer_image_load(const char *response);
+static void image_load_failed(void);
+static void answer_video_switch(const char *response);
+static void end_video_switch(void);
+static void video_switch_done(void);
+static void video_switch_failed(void);
+static bool switch_video(const char *new_path);
+static bool switch_to_video(const char *new_path);
+static void stop_video_pipeline(void);
+static void apply_image_fill_default(bool image);
+static void remember_restart_path(const char *new_path);
 static void save_current_state(void);
 static int restore_from_state(const char *path);
 static void restore_video_position(void);
 static void notify_systemd_ready(void);
 static void notify_systemd_stopping(void);
 static bool is_all_outputs_selector(const char *monitor);
+static void stop_gpu_encoder(void);
 
 // Cleanup function
 static void exit_cleanup() {
 
-    // Tell the events thread to stop sleeping/seeking against the pipeline.
-    // It cannot be cancelled (it runs with cancellation disabled), so it must
-    // observe this flag before we free video_path and unref the pipeline.
+    // Stop bus handlers and the GIF loop timer from seeking against the
+    // pipeline before we free video_path and unref it.
     shutting_down = 1;
 
     // Notify systemd that we're stopping
@@ -318,6 +772,7 @@ static void exit_cleanup() {
 
     // Give GStreamer a chance to finish
     halt_info.stop_render_loop = 1;
+    wake_main_loop();
     for (int trys=10; halt_info.stop_render_loop && trys > 0; trys--) {
         usleep(10000);
     }
@@ -325,33 +780,59 @@ static void exit_cleanup() {
     if (halt_info.stop_render_loop && VERBOSE)
         cflp_warning("Failed to quit GStreamer");
 
-    // Cancel all threads
-    for (uint i=0; threads[i] != 0; i++) {
-        if (pthread_self() != threads[i])
-            pthread_cancel(threads[i]);
-    }
+    // Render threads sample texture_manager's textures
+    stop_all_render_threads();
 
     // Clean up texture manager
     cleanup_texture_manager();
 
+    // The GPU encoder and preload workers add to the cache; stop them first
+    stop_gpu_encoder();
+    preload_shutdown();
+    diskcache_shutdown();
+
     // Clean up image cache
     cache_shutdown();
 
+    // An IPC client may still be waiting on an image change
+    if (image_load.client_fd >= 0) {
+        close(image_load.client_fd);
+        image_load.client_fd = -1;
+    }
+    if (video_switch.client_fd >= 0) {
+        close(video_switch.client_fd);
+        video_switch.client_fd = -1;
+    }
+    if (decoder_replug.client_fd >= 0) {
+        close(decoder_replug.client_fd);
+        decoder_replug.client_fd = -1;
+    }
+
     // Clean up transition resources
     cancel_transition();
     if (transition_shader_program != 0) {
         glDeleteProgram(transition_shader_program);
         transition_shader_program = 0;
     }
+    if (transition_timer.query != 0) {
+        glDeleteQueries(1, &transition_timer.query);
+        transition_timer.query = 0;
+        transition_timer.pending = false;
+    }
+    if (transition_state.old_vao != 0) {
+        glDeleteVertexArrays(1, &transition_state.old_vao);
+        glDeleteBuffers(1, &transition_state.old_vbo);
+        transition_state.old_vao = 0;
+        transition_state.old_vbo = 0;
+    }
     
     if (pipeline) {
         // More graceful GStreamer shutdown sequence
         if (VERBOSE)
             cflp_info("Starting graceful GStreamer shutdown...");
             
-        // Remove bus watch to prevent callbacks during shutdown
+        // Drop the bus so the main loop stops dispatching its messages
         if (bus) {
-            gst_bus_remove_watch(bus);
             gst_object_unref(bus);
             bus = NULL;
         }
@@ -373,6 +854,27 @@ static void exit_cleanup() {
         if (VERBOSE)
             cflp_info("GStreamer shutdown completed");
     }
+
+    if (gst_gl.app_context) {
+        gst_object_unref(gst_gl.app_context);
+        gst_gl.app_context = NULL;
+    }
+    if (gst_gl.display) {
+        gst_object_unref(gst_gl.display);
+        gst_gl.display = NULL;
+    }
+    if (decode_filter.rate) {
+        gst_object_unref(decode_filter.rate);
+        decode_filter.rate = NULL;
+    }
+    if (decode_filter.crop) {
+        gst_object_unref(decode_filter.crop);
+        decode_filter.crop = NULL;
+    }
+    if (decode_filter.scale_caps) {
+        gst_object_unref(decode_filter.scale_caps);
+        decode_filter.scale_caps = NULL;
+    }
     
     // Clean up allocated URI
     if (allocated_uri) {
@@ -440,9 +942,9 @@ static void exit_cleanup() {
         glDeleteBuffers(1, &vbo);
         vbo = 0;
     }
-    if (shader_program != 0) {
-        glDeleteProgram(shader_program);
-        shader_program = 0;
+    if (frame_shader.program != 0) {
+        glDeleteProgram(frame_shader.program);
+        frame_shader.program = 0;
     }
 
     // Free IPC socket path
@@ -463,8 +965,40 @@ static void init_texture_manager() {
         cflp_info("Initialized smart texture manager");
 }
 
+// Drop the DMA-BUF currently bound as texture storage (if any).
+// The texture keeps its name; get_texture_for_dimensions() respecifies storage
+// on next use because current_width/height are reset.
+static void release_dmabuf_import(void) {
+    if (texture_manager.egl_image) {
+        egl_dmabuf.destroy_image(egl_display, texture_manager.egl_image);
+        texture_manager.egl_image = NULL;
+        texture_manager.current_width = 0;
+        texture_manager.current_height = 0;
+    }
+    if (texture_manager.dmabuf_buffer) {
+        gst_buffer_unref(texture_manager.dmabuf_buffer);
+        texture_manager.dmabuf_buffer = NULL;
+    }
+}
+
+// Drop the GstGLMemory frame being displayed (if any). Like
+// release_dmabuf_import(), resets current dimensions so the managed texture
+// is respecified before its next use.
+static void release_gl_frame(void) {
+    if (texture_manager.gl_buffer) {
+        gst_buffer_unmap(texture_manager.gl_buffer, &texture_manager.gl_map);
+        gst_buffer_unref(texture_manager.gl_buffer);
+        texture_manager.gl_buffer = NULL;
+        texture_manager.gl_texture = 0;
+        texture_manager.current_width = 0;
+        texture_manager.current_height = 0;
+    }
+}
+
 // Clean up texture manager
 static void cleanup_texture_manager() {
+    release_dmabuf_import();
+    release_gl_frame();
     if (texture_manager.initialized) {
         glDeleteTextures(1, &texture_manager.texture);
         texture_manager.texture = 0;
@@ -472,6 +1006,11 @@ static void cleanup_texture_manager() {
         if (VERBOSE)
             cflp_info("Cleaned up texture manager");
     }
+    if (texture_manager.chroma[0] != 0) {
+        glDeleteTextures(2, texture_manager.chroma);
+        texture_manager.chroma[0] = 0;
+        texture_manager.chroma[1] = 0;
+    }
     // CHANGED 2026-07-08 - Delete upload PBOs - Problem: new GL objects need cleanup
     if (texture_manager.pbo[0] != 0) {
         glDeleteBuffers(2, texture_manager.pbo);
@@ -480,18 +1019,66 @@ static void cleanup_texture_manager() {
     }
 }
 
+// Switch the managed textures to a new pixel layout. Storage is respecified
+// by the next get_texture_for_dimensions() call.
+static void set_texture_format(frame_format_t format) {
+    if (texture_manager.format == format)
+        return;
+    texture_manager.format = format;
+    texture_manager.current_width = 0;
+    texture_manager.current_height = 0;
+    if (VERBOSE)
+        cflp_info("Texture format changed to %s", format == FRAME_FORMAT_NV12 ? "NV12" :
+                  format == FRAME_FORMAT_I420 ? "I420" : "RGBA");
+}
+
+static void init_plane_texture(GLuint texture) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
+
+// (Re)specify storage for every plane of the current format
+static void allocate_frame_storage(int width, int height) {
+    texture_manager.compressed = FALSE;
+    init_plane_texture(texture_manager.texture);
+    if (texture_manager.format == FRAME_FORMAT_RGBA) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height,
+                     0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height,
+                     0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+
+        if (texture_manager.chroma[0] == 0) {
+            glGenTextures(2, texture_manager.chroma);
+            init_plane_texture(texture_manager.chroma[0]);
+            init_plane_texture(texture_manager.chroma[1]);
+        }
+        // 4:2:0 chroma, rounded up for odd dimensions
+        int chroma_width = (width + 1) / 2;
+        int chroma_height = (height + 1) / 2;
+        glBindTexture(GL_TEXTURE_2D, texture_manager.chroma[0]);
+        if (texture_manager.format == FRAME_FORMAT_NV12) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, chroma_width, chroma_height,
+                         0, GL_RG, GL_UNSIGNED_BYTE, NULL);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, chroma_width, chroma_height,
+                         0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+            glBindTexture(GL_TEXTURE_2D, texture_manager.chroma[1]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, chroma_width, chroma_height,
+                         0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 // Get texture for current dimensions with smart allocation
 static GLuint get_texture_for_dimensions(int width, int height) {
     if (!texture_manager.initialized) {
         // First-time initialization
-        glBindTexture(GL_TEXTURE_2D, texture_manager.texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 
-                     0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        allocate_frame_storage(width, height);
         
         texture_manager.current_width = width;
         texture_manager.current_height = height;
@@ -504,11 +1091,9 @@ static GLuint get_texture_for_dimensions(int width, int height) {
     }
     
     // Check if we need to reallocate
-    if (texture_manager.current_width != width || texture_manager.current_height != height) {
-        glBindTexture(GL_TEXTURE_2D, texture_manager.texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 
-                     0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-        glBindTexture(GL_TEXTURE_2D, 0);
+    if (texture_manager.current_width != width || texture_manager.current_height != height ||
+        texture_manager.compressed) {
+        allocate_frame_storage(width, height);
         
         texture_manager.current_width = width;
         texture_manager.current_height = height;
@@ -521,10 +1106,11 @@ static GLuint get_texture_for_dimensions(int width, int height) {
 }
 
 // CHANGED 2026-07-08 - Upload via ping-ponged PBOs so the driver DMAs frame N-1 while we write frame N - Problem: synchronous client-memory uploads stalled rendering
-// Must be called with a current EGL context; binds and restores its own GL state.
-static void upload_frame_to_texture(GLuint texture, const void *data, gsize size, int width, int height) {
-    glBindTexture(GL_TEXTURE_2D, texture);
-
+// CHANGED 2026-10-16 - Split PBO staging from the texture writes - Problem: YUV frames upload several planes from one staged buffer
+// Copies the frame into the next PBO and leaves it bound. Returns the base to
+// add plane offsets to: NULL (offset 0 of the bound PBO) when staged, or
+// `data` itself when the PBO path is unavailable.
+static const guint8 *stage_pixels_for_upload(const void *data, gsize size) {
     if (!texture_manager.pbo_disabled) {
         if (texture_manager.pbo[0] == 0) {
             // CHANGED 2026-07-09 - Gate PBO path to NVIDIA - Problem: on Mesa/Intel UMA the direct upload path is already efficient and the PBO round-trip measurably regressed throughput (4K60 on UHD 620: 1872 rendered of 3792 captured)
@@ -555,13 +1141,8 @@ static void upload_frame_to_texture(GLuint texture, const void *data, gsize size
             if (dst) {
                 memcpy(dst, data, size);
                 // CHANGED 2026-07-09 - Check glUnmapBuffer result - Problem: GL_FALSE means the buffer store was lost and its contents are undefined; uploading from it would display corruption
-                if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
-                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
-                                    GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-                    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-                    glBindTexture(GL_TEXTURE_2D, 0);
-                    return;
-                }
+                if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE)
+                    return NULL;
                 // Buffer store lost (rare, e.g. after a mode switch); upload
                 // this frame directly from client memory instead
                 if (VERBOSE)
@@ -573,10 +1154,148 @@ static void upload_frame_to_texture(GLuint texture, const void *data, gsize size
             glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
         }
     }
+    return data;
+}
+
+static void upload_plane(GLuint texture, const guint8 *src, int width, int height,
+                         gint stride, int bytes_per_pixel, GLenum format) {
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, stride > 0 ? stride / bytes_per_pixel : 0);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, src);
+}
+
+// Upload one mapped frame into the managed textures, which must already be
+// sized by get_texture_for_dimensions(). offsets/strides describe each plane
+// within data; a stride of 0 means tightly packed rows.
+// Must be called with a current EGL context; binds and restores its own GL state.
+static void upload_frame_to_texture(const void *data, gsize size, int width, int height,
+                                    const gsize *offsets, const gint *strides) {
+    const guint8 *src = stage_pixels_for_upload(data, size);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (texture_manager.format == FRAME_FORMAT_RGBA) {
+        upload_plane(texture_manager.texture, src + offsets[0], width, height, strides[0], 4, GL_RGBA);
+    } else {
+        int chroma_width = (width + 1) / 2;
+        int chroma_height = (height + 1) / 2;
+        upload_plane(texture_manager.texture, src + offsets[0], width, height, strides[0], 1, GL_RED);
+        if (texture_manager.format == FRAME_FORMAT_NV12) {
+            upload_plane(texture_manager.chroma[0], src + offsets[1], chroma_width, chroma_height,
+                         strides[1], 2, GL_RG);
+        } else {
+            upload_plane(texture_manager.chroma[0], src + offsets[1], chroma_width, chroma_height,
+                         strides[1], 1, GL_RED);
+            upload_plane(texture_manager.chroma[1], src + offsets[2], chroma_width, chroma_height,
+                         strides[2], 1, GL_RED);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Derive the YCbCr -> RGB matrix for the frame's colorimetry. Unknown
+// matrices fall back to BT.709; anything but full range is treated as
+// limited (16-235 luma, 16-240 chroma).
+static void update_yuv_coefficients(GstVideoColorMatrix matrix, GstVideoColorRange range) {
+    if (texture_manager.yuv_matrix[0] != 0.0f &&
+        texture_manager.color_matrix == matrix && texture_manager.color_range == range)
+        return;
+
+    gdouble kr, kb;
+    if (!gst_video_color_matrix_get_Kr_Kb(matrix, &kr, &kb)) {
+        kr = 0.2126;
+        kb = 0.0722;
+    }
+    gdouble kg = 1.0 - kr - kb;
+    gboolean full = range == GST_VIDEO_COLOR_RANGE_0_255;
+    gfloat ys = full ? 1.0f : 255.0f / 219.0f;
+    gfloat cs = full ? 1.0f : 255.0f / 224.0f;
+
+    // Columns are the Y, Cb and Cr contributions
+    GLfloat *m = texture_manager.yuv_matrix;
+    m[0] = ys;  m[1] = ys;  m[2] = ys;
+    m[3] = 0.0f;
+    m[4] = (GLfloat)(-cs * 2.0 * kb * (1.0 - kb) / kg);
+    m[5] = (GLfloat)(cs * 2.0 * (1.0 - kb));
+    m[6] = (GLfloat)(cs * 2.0 * (1.0 - kr));
+    m[7] = (GLfloat)(-cs * 2.0 * kr * (1.0 - kr) / kg);
+    m[8] = 0.0f;
+    texture_manager.yuv_offset[0] = full ? 0.0f : 16.0f / 255.0f;
+    texture_manager.yuv_offset[1] = 128.0f / 255.0f;
+    texture_manager.yuv_offset[2] = 128.0f / 255.0f;
+
+    texture_manager.color_matrix = matrix;
+    texture_manager.color_range = range;
+    if (VERBOSE)
+        cflp_info("YUV conversion: Kr=%.4f Kb=%.4f, %s range", kr, kb, full ? "full" : "limited");
+}
+
+// Import the pending DMA-BUF frame as an EGLImage and make it the storage of
+// the managed texture. Takes over the frame's buffer ref on success; the
+// previous import is released only after the new one is bound so the texture
+// never samples freed memory. Caller must hold video_mutex and have a current
+// EGL context. Returns false if the driver rejected the buffer.
+static bool import_dmabuf_frame_locked(GLuint texture) {
+    EGLint attribs[] = {
+        EGL_WIDTH, video_frame_data.width,
+        EGL_HEIGHT, video_frame_data.height,
+        EGL_LINUX_DRM_FOURCC_EXT, DRM_FOURCC_ABGR8888,
+        EGL_DMA_BUF_PLANE0_FD_EXT, video_frame_data.dmabuf_fd,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT, (EGLint)video_frame_data.dmabuf_offset,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT, video_frame_data.dmabuf_stride,
+        EGL_NONE, EGL_NONE,
+        EGL_NONE, EGL_NONE,
+        EGL_NONE
+    };
+    if (egl_dmabuf.modifiers && video_frame_data.dmabuf_modifier != DRM_MODIFIER_INVALID) {
+        attribs[12] = EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT;
+        attribs[13] = (EGLint)(video_frame_data.dmabuf_modifier & 0xffffffff);
+        attribs[14] = EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT;
+        attribs[15] = (EGLint)(video_frame_data.dmabuf_modifier >> 32);
+    }
+
+    EGLImageKHR image = egl_dmabuf.create_image(egl_display, EGL_NO_CONTEXT,
+                                                EGL_LINUX_DMA_BUF_EXT, NULL, attribs);
+    if (!image)
+        return false;
 
-    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
-                    GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    egl_dmabuf.image_target_texture(GL_TEXTURE_2D, image);
     glBindTexture(GL_TEXTURE_2D, 0);
+
+    // The texture now references the new image; drop the previous import
+    release_dmabuf_import();
+    texture_manager.egl_image = image;
+    texture_manager.dmabuf_buffer = video_frame_data.buffer;
+    texture_manager.current_width = video_frame_data.width;
+    texture_manager.current_height = video_frame_data.height;
+
+    // Ownership moved to texture_manager
+    video_frame_data.buffer = NULL;
+    video_frame_data.is_dmabuf = FALSE;
+    return true;
+}
+
+// Upload the pending DMA-BUF frame through a CPU mapping when import fails.
+// Caller must hold video_mutex and have a current EGL context.
+static void upload_dmabuf_frame_mapped_locked(void) {
+    GstMapInfo map;
+    if (!gst_buffer_map(video_frame_data.buffer, &map, GST_MAP_READ)) {
+        cflp_warning("Failed to map DMA-BUF frame for fallback upload");
+        return;
+    }
+    // Texture storage may still be the previous import; never write into it
+    release_dmabuf_import();
+    get_texture_for_dimensions(video_frame_data.width, video_frame_data.height);
+    // Exported buffers are often pitch-aligned; pass the real stride
+    gsize offsets[3] = { video_frame_data.dmabuf_offset, 0, 0 };
+    gint strides[3] = { video_frame_data.dmabuf_stride, 0, 0 };
+    upload_frame_to_texture(map.data, map.size, video_frame_data.width, video_frame_data.height,
+                            offsets, strides);
+    gst_buffer_unmap(video_frame_data.buffer, &map);
 }
 
 static void exit_slapper(int reason) {
@@ -596,8 +1315,19 @@ static void exit_slapper(int reason) {
 // is delivered, calls process_pending_signal() to do the shutdown from normal context.
 static volatile sig_atomic_t pending_signal = 0;
 
+// Wake the main loop's poll(); async-signal-safe
+static bool wake_main_loop(void) {
+    uint64_t one = 1;
+    // EAGAIN means the counter is saturated, so a wakeup is already pending
+    return write(wakeup_fd, &one, sizeof(one)) == sizeof(one) || errno == EAGAIN;
+}
+
 static void handle_signal(int signum) {
     pending_signal = signum;
+    // The signal may land on any thread; poll() only sees EINTR on the main thread
+    int saved_errno = errno;
+    wake_main_loop();
+    errno = saved_errno;
 }
 
 // Performs the shutdown work handle_signal used to do, from normal context.
@@ -650,8 +1380,23 @@ static GLuint create_shader_program() {
         "in vec2 TexCoord;\n"
         "out vec4 FragColor;\n"
         "uniform sampler2D ourTexture;\n"
+        "uniform sampler2D chromaTexture0;\n"
+        "uniform sampler2D chromaTexture1;\n"
+        "uniform int yuvMode;\n"            // 0 = RGBA, 1 = NV12, 2 = I420
+        "uniform mat3 yuvToRgb;\n"
+        "uniform vec3 yuvOffset;\n"
         "void main() {\n"
-        "    FragColor = texture(ourTexture, TexCoord);\n"
+        "    if (yuvMode == 0) {\n"
+        "        FragColor = texture(ourTexture, TexCoord);\n"
+        "        return;\n"
+        "    }\n"
+        "    vec3 yuv;\n"
+        "    yuv.x = texture(ourTexture, TexCoord).r;\n"
+        "    if (yuvMode == 1)\n"
+        "        yuv.yz = texture(chromaTexture0, TexCoord).rg;\n"
+        "    else\n"
+        "        yuv.yz = vec2(texture(chromaTexture0, TexCoord).r, texture(chromaTexture1, TexCoord).r);\n"
+        "    FragColor = vec4(clamp(yuvToRgb * (yuv - yuvOffset), 0.0, 1.0), 1.0);\n"
         "}\0";
     
     GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
@@ -702,7 +1447,8 @@ static GLuint create_shader_program() {
     return program;
 }
 
-// Create shader program for transition effects (blends two textures)
+// Create shader program for transition effects (draws the outgoing frame
+// scaled by its remaining weight, for additive blending over the new one)
 static GLuint create_transition_shader_program() {
     const char *vertex_shader_source = 
         "#version 330 core\n"
@@ -719,12 +1465,9 @@ static GLuint create_transition_shader_program() {
         "in vec2 TexCoord;\n"
         "out vec4 FragColor;\n"
         "uniform sampler2D oldTexture;\n"
-        "uniform sampler2D newTexture;\n"
         "uniform float alpha;\n"
         "void main() {\n"
-        "    vec4 oldColor = texture(oldTexture, TexCoord);\n"
-        "    vec4 newColor = texture(newTexture, TexCoord);\n"
-        "    FragColor = mix(oldColor, newColor, alpha);\n"
+        "    FragColor = vec4(texture(oldTexture, TexCoord).rgb, 1.0) * alpha;\n"
         "}\0";
     
     GLuint vertex_shader = glCreateShader(GL_VERTEX_SHADER);
@@ -782,10 +1525,10 @@ static bool should_use_transition(const char *new_path) {
         return false;
     }
     
-    // Only transition between static images (not videos or animated GIFs)
-    if (!is_image_mode || !is_static_image_path(new_path)) {
-        return false;
-    }
+    // CHANGED 2026-10-16 - Video and mixed image/video changes fade too - Problem: only image to image changes
+    // could transition; every other change cut hard
+    // Every change is handled in-process, so any pair of wallpapers can fade
+    // as long as a frame is on screen to fade from (checked below)
     
     // Don't start a new transition if one is already active
     if (transition_state.active) {
@@ -804,48 +1547,127 @@ static bool should_use_transition(const char *new_path) {
     return true;
 }
 
+// Copy the frame on screen into an RGBA texture at its own resolution.
+// Works for every upload format (YUV planes, DMA-BUF imports, GStreamer GL
+// memory), so the new pipeline can take texture_manager over straight away.
+// Runs on the main context; uploads only happen there, so nothing writes
+// the source textures meanwhile.
+static GLuint capture_transition_frame(void) {
+    if (!eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context)) {
+        cflp_error("Failed to make context current for transition capture");
+        return 0;
+    }
+    if (!ensure_shader_program())
+        return 0;
+
+    struct render_frame frame;
+    snapshot_render_frame(&frame);
+    if (frame.width <= 0 || frame.height <= 0)
+        return 0;
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    init_plane_texture(texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, frame.width, frame.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLuint fbo;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete) {
+        // Whole target, with t following framebuffer rows so the copy keeps
+        // the source's orientation and draws with the usual quad
+        const float vertices[] = {
+            -1.0f, -1.0f,  0.0f, 0.0f,
+             1.0f, -1.0f,  1.0f, 0.0f,
+             1.0f,  1.0f,  1.0f, 1.0f,
+            -1.0f,  1.0f,  0.0f, 1.0f,
+        };
+        GLuint quad_vao, quad_vbo;
+        create_quad_buffers(&quad_vao, &quad_vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        glViewport(0, 0, frame.width, frame.height);
+        draw_render_frame(&frame, &frame_shader, quad_vao);
+
+        glDeleteBuffers(1, &quad_vbo);
+        glDeleteVertexArrays(1, &quad_vao);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+
+    if (!complete) {
+        cflp_warning("Transition capture framebuffer incomplete");
+        glDeleteTextures(1, &texture);
+        return 0;
+    }
+    return texture;
+}
+
+// Add the GL_TIME_ELAPSED query result of the last timed transition draw to render_stats
+static void collect_transition_timer(bool wait) {
+    if (!transition_timer.pending)
+        return;
+    if (!wait) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(transition_timer.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return;
+    }
+    GLuint64 ns = 0;
+    glGetQueryObjectui64v(transition_timer.query, GL_QUERY_RESULT, &ns);
+    transition_timer.pending = false;
+
+    pthread_mutex_lock(&render_stats.lock);
+    render_stats.transition_frames++;
+    render_stats.transition_total_ns += (int64_t)ns;
+    if ((int64_t)ns > render_stats.transition_max_ns)
+        render_stats.transition_max_ns = (int64_t)ns;
+    pthread_mutex_unlock(&render_stats.lock);
+}
+
 // Start a transition by capturing the current wallpaper state
 static void start_transition(const char *new_path) {
     if (!should_use_transition(new_path)) {
         return;
     }
     
-    pthread_mutex_lock(&video_mutex);
+    // CHANGED 2026-10-16 - Capture a copy of the frame instead of keeping texture_manager's texture - Problem: video
+    // frames live in YUV planes or imported buffers that the new pipeline replaces
+    GLuint texture = capture_transition_frame();
+    if (texture == 0) {
+        if (VERBOSE)
+            cflp_warning("Could not capture the current frame, changing without transition");
+        return;
+    }
     
-    // Capture current texture and dimensions
-    transition_state.old_texture = texture_manager.texture;
-    transition_state.old_width = video_frame_data.width;
-    transition_state.old_height = video_frame_data.height;
+    // Stats cover the latest transition; the previous one's last draw finished long ago
+    collect_transition_timer(true);
+    pthread_mutex_lock(&render_stats.lock);
+    render_stats.transition_frames = 0;
+    render_stats.transition_total_ns = 0;
+    render_stats.transition_max_ns = 0;
+    pthread_mutex_unlock(&render_stats.lock);
     
-    // Capture current scaling (needed for rendering old texture during transition)
-    // For now, store current scale values (will be updated in render_transition)
-    transition_state.old_scale_x = 1.0f;
-    transition_state.old_scale_y = 1.0f;
+    transition_state.old_texture = texture;
+    transition_state.old_width = texture_manager.current_width;
+    transition_state.old_height = texture_manager.current_height;
     
     // Mark transition as active
     transition_state.active = true;
+    transition_state.awaiting_frame = true;
     transition_state.elapsed = 0.0f;
     transition_state.progress = 0.0f;
     transition_state.alpha_old = 1.0f;
     transition_state.alpha_new = 0.0f;
     
-    // Record start time
+    // Record start time (restarted when the first new frame is uploaded)
     clock_gettime(CLOCK_MONOTONIC, &transition_state.start_time);
     
-    // Create a NEW texture for the incoming image
-    // The old texture is now in transition_state.old_texture
-    // We need a fresh texture for the new image
-    glGenTextures(1, &texture_manager.texture);
-    texture_manager.initialized = FALSE;  // Force re-initialization for new dimensions
-    texture_manager.current_width = 0;
-    texture_manager.current_height = 0;
-    
-    if (VERBOSE)
-        cflp_info("Created new texture %u for transition (old: %u)", 
-                 texture_manager.texture, transition_state.old_texture);
-    
-    pthread_mutex_unlock(&video_mutex);
-    
     if (VERBOSE) {
         cflp_info("Starting %s transition from %dx%d to %s",
                  transition_state.type == TRANSITION_FADE ? "fade" : "unknown",
@@ -867,6 +1689,17 @@ static void update_transition(void) {
                           (current_time.tv_nsec - transition_state.start_time.tv_nsec);
     transition_state.elapsed = (float)elapsed_ns / 1e9f;
     
+    // Hold the old frame until the new wallpaper has one to fade to
+    if (transition_state.awaiting_frame) {
+        if (transition_state.elapsed < TRANSITION_FRAME_TIMEOUT_S)
+            return;
+        if (VERBOSE)
+            cflp_warning("No frame from the new wallpaper after %.1f s, fading anyway", TRANSITION_FRAME_TIMEOUT_S);
+        transition_state.awaiting_frame = false;
+        transition_state.start_time = current_time;
+        transition_state.elapsed = 0.0f;
+    }
+    
     // Calculate progress (0.0 to 1.0)
     transition_state.progress = transition_state.elapsed / transition_state.duration;
     
@@ -886,7 +1719,17 @@ static void update_transition(void) {
     }
 }
 
-// Render the transition frame (blends old and new textures)
+// The new wallpaper's first frame is in texture_manager: start the fade clock
+static void transition_frame_arrived(void) {
+    if (!transition_state.active || !transition_state.awaiting_frame)
+        return;
+    transition_state.awaiting_frame = false;
+    clock_gettime(CLOCK_MONOTONIC, &transition_state.start_time);
+}
+
+// Render the transition frame (blends old and new frames)
+// CHANGED 2026-10-16 - Draw each frame with its own quad and format, summed by weight - Problem: the old
+// texture was sampled through the new frame's quad, and a YUV new frame was read as RGBA
 static void render_transition(struct display_output *output) {
     if (!transition_state.active) {
         return;
@@ -905,52 +1748,67 @@ static void render_transition(struct display_output *output) {
             return;
         }
     }
+    if (!ensure_shader_program())
+        return;
     
-    // NOTE: Caller (render()) already holds video_mutex - don't lock again!
-    
-    // Check if we have both textures
-    if (transition_state.old_texture == 0 || texture_manager.texture == 0) {
+    if (transition_state.old_texture == 0) {
         if (VERBOSE)
             cflp_warning("Missing textures for transition, canceling");
         cancel_transition();
         return;
     }
     
-    // Update new texture dimensions if available
-    if (video_frame_data.width > 0 && video_frame_data.height > 0) {
-        transition_state.new_width = video_frame_data.width;
-        transition_state.new_height = video_frame_data.height;
-    }
+    if (transition_state.old_vao == 0)
+        create_quad_buffers(&transition_state.old_vao, &transition_state.old_vbo);
+    if (vao == 0)
+        create_quad_buffers(&vao, &vbo);
     
-    // Use transition shader
-    glUseProgram(transition_shader_program);
+    // Both frames are added onto the black clear, each weighted by its alpha,
+    // so letterbox bars that differ between them fade too. Two textured passes
+    // no larger than the output; their GPU time is reported by the stats command.
+    collect_transition_timer(false);
+    bool timing = GLAD_GL_VERSION_3_3 && !transition_timer.pending;
+    if (timing) {
+        if (transition_timer.query == 0)
+            glGenQueries(1, &transition_timer.query);
+        glBeginQuery(GL_TIME_ELAPSED, transition_timer.query);
+    }
+    glEnable(GL_BLEND);
     
-    // Bind old texture to texture unit 0
+    // Outgoing frame: the transition shader applies its weight
+    update_quad_vertices(output, transition_state.old_vbo,
+                         transition_state.old_width, transition_state.old_height);
+    glBlendFunc(GL_ONE, GL_ONE);
+    glUseProgram(transition_shader_program);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, transition_state.old_texture);
     glUniform1i(glGetUniformLocation(transition_shader_program, "oldTexture"), 0);
-    
-    // Bind new texture to texture unit 1
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, texture_manager.texture);
-    glUniform1i(glGetUniformLocation(transition_shader_program, "newTexture"), 1);
-    
-    // Set alpha blend value
-    glUniform1f(glGetUniformLocation(transition_shader_program, "alpha"), transition_state.alpha_new);
-    
-    // Use the same vertex data as normal rendering
-    // (update_vertex_data will have been called with new dimensions)
-    glBindVertexArray(vao);
+    glUniform1f(glGetUniformLocation(transition_shader_program, "alpha"), transition_state.alpha_old);
+    glBindVertexArray(transition_state.old_vao);
     glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
     glBindVertexArray(0);
-    
-    // Clean up
     glUseProgram(0);
     glBindTexture(GL_TEXTURE_2D, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, 0);
     
-    // NOTE: Don't unlock mutex - caller (render()) will do it
+    // Incoming frame, live from the new pipeline in whatever format it uploads;
+    // the regular shader is shared, so its weight comes from the blend color.
+    // Drawn last so the output's quad scale (damage) follows the new frame.
+    if (texture_manager.initialized && texture_manager.texture != 0) {
+        transition_state.new_width = texture_manager.current_width;
+        transition_state.new_height = texture_manager.current_height;
+        update_vertex_data(output);
+        struct render_frame frame;
+        snapshot_render_frame(&frame);
+        glBlendColor(0.0f, 0.0f, 0.0f, transition_state.alpha_new);
+        glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE);
+        draw_render_frame(&frame, &frame_shader, vao);
+    }
+    
+    glDisable(GL_BLEND);
+    if (timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        transition_timer.pending = true;
+    }
 }
 
 // Complete transition - cleanup old texture
@@ -969,6 +1827,7 @@ static void complete_transition(void) {
     
     // Reset transition state
     transition_state.active = false;
+    transition_state.awaiting_frame = false;
     transition_state.progress = 1.0f;
     transition_state.elapsed = transition_state.duration;
     
@@ -995,6 +1854,7 @@ static void cancel_transition(void) {
     
     // Reset transition state
     transition_state.active = false;
+    transition_state.awaiting_frame = false;
     transition_state.progress = 0.0f;
     transition_state.elapsed = 0.0f;
     
@@ -1005,17 +1865,11 @@ static void cancel_transition(void) {
     }
 }
 
-// Update vertex data based on video dimensions and scaling options
-static void update_vertex_data(struct display_output *output) {
-    if (vao == 0 || vbo == 0) {
-        if (VERBOSE)
-            cflp_info("VAO/VBO not initialized yet (vao=%u, vbo=%u)", vao, vbo);
-        return; // VAO/VBO not initialized yet
-    }
-    
-    // CHANGED 2026-07-09 - Read dimensions from texture_manager (last uploaded frame), not video_frame_data - Problem: called from the render path outside video_mutex; video_frame_data belongs to the probe thread
-    int vid_width = texture_manager.current_width;
-    int vid_height = texture_manager.current_height;
+// Fill quad_vbo with the quad for a vid_width x vid_height texture on output
+// CHANGED 2026-10-16 - Take the VBO and dimensions as parameters - Problem: render threads draw with their own VAO/VBO and frame snapshot
+static void update_quad_vertices(struct display_output *output, GLuint quad_vbo, int vid_width, int vid_height) {
+    output->quad_scale_x = 1.0f;
+    output->quad_scale_y = 1.0f;
 
     // Only update if we have valid video dimensions
     if (vid_width <= 0 || vid_height <= 0) {
@@ -1100,6 +1954,8 @@ static void update_vertex_data(struct display_output *output) {
     if (scale_x > 10.0f) scale_x = 10.0f;
     if (scale_y < 0.1f) scale_y = 0.1f;
     if (scale_y > 10.0f) scale_y = 10.0f;
+    output->quad_scale_x = scale_x;
+    output->quad_scale_y = scale_y;
     
     // Create vertices with calculated scaling (centered)
     float vertices[] = {
@@ -1111,7 +1967,7 @@ static void update_vertex_data(struct display_output *output) {
     };
     
     // Update vertex buffer data
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     
@@ -1121,143 +1977,531 @@ static void update_vertex_data(struct display_output *output) {
     }
 }
 
-static void render(struct display_output *output) {
-    // If using waylandsink, we don't need EGL rendering - waylandsink handles it
-    if (using_waylandsink) {
-        // Just schedule the next frame callback
-        output->frame_callback = wl_surface_frame(output->surface);
-        wl_callback_add_listener(output->frame_callback, &wl_surface_frame_listener, output);
-        output->redraw_needed = false;
-        return;
+// Update vertex data based on video dimensions and scaling options
+static void update_vertex_data(struct display_output *output) {
+    if (vao == 0 || vbo == 0) {
+        if (VERBOSE)
+            cflp_info("VAO/VBO not initialized yet (vao=%u, vbo=%u)", vao, vbo);
+        return; // VAO/VBO not initialized yet
     }
 
-    // For image mode, only render once unless redraw explicitly needed or transitioning
-    if (is_image_mode && !output->redraw_needed && texture_manager.initialized && !transition_state.active) {
-        return;  // Image already rendered, no continuous updates needed
-    }
+    // CHANGED 2026-07-09 - Read dimensions from texture_manager (last uploaded frame), not video_frame_data - Problem: called from the render path outside video_mutex; video_frame_data belongs to the probe thread
+    update_quad_vertices(output, vbo, texture_manager.current_width, texture_manager.current_height);
+}
 
-    // Make sure we have a valid context
-    if (!eglMakeCurrent(egl_display, output->egl_surface, output->egl_surface, egl_context)) {
-        cflp_error("Failed to make output surface current");
-        return;
-    }
+// Create a VAO/VBO pair laid out for the textured quad (x, y, s, t)
+static void create_quad_buffers(GLuint *quad_vao, GLuint *quad_vbo) {
+    glGenVertexArrays(1, quad_vao);
+    glGenBuffers(1, quad_vbo);
 
-    glViewport(0, 0, output->width * output->scale, output->height * output->scale);
-    
-    // Clear with black background
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+    glBindVertexArray(*quad_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, *quad_vbo);
 
-    // Update transition progress if active
-    update_transition();
+    // Position attribute
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
 
-    // Frame rate limiting for GPU optimization
-    struct timespec current_time;
-    clock_gettime(CLOCK_MONOTONIC, &current_time);
-    long long time_since_last_render = (current_time.tv_sec - last_render_time.tv_sec) * 1000000000LL + 
-                                       (current_time.tv_nsec - last_render_time.tv_nsec);
-    
-    // Adaptive frame skipping for better performance under load
-    gboolean should_render = FALSE;
-    pthread_mutex_lock(&video_mutex);
-    
-    if (video_frame_data.has_new_frame) {
-        if (VERBOSE)
-            cflp_info("FOUND NEW FRAME - will render");
-        should_render = TRUE; // Always render if we have a new frame
-        frames_skipped = 0; // Reset skip counter when we render
-    } else {
-        if (VERBOSE == 2)
-            cflp_info("No new frame found");
+    // Texture coordinate attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+
+    if (VERBOSE)  // Keep this as it's a one-time message
+        cflp_info("Created VAO %u and VBO %u", *quad_vao, *quad_vbo);
+}
+
+static void snapshot_render_frame(struct render_frame *frame) {
+    // CHANGED 2026-07-09 - Read dimensions from texture_manager, not video_frame_data - Problem: this now runs outside video_mutex; texture_manager is render-thread-owned
+    // CHANGED 2026-10-16 - GstGLMemory frames are sampled in place - Problem: --upload gl
+    frame->texture = texture_manager.gl_texture ? texture_manager.gl_texture :
+        get_texture_for_dimensions(texture_manager.current_width, texture_manager.current_height);
+    frame->chroma[0] = texture_manager.chroma[0];
+    frame->chroma[1] = texture_manager.chroma[1];
+    frame->format = texture_manager.format;
+    frame->width = texture_manager.current_width;
+    frame->height = texture_manager.current_height;
+    memcpy(frame->yuv_matrix, texture_manager.yuv_matrix, sizeof(frame->yuv_matrix));
+    memcpy(frame->yuv_offset, texture_manager.yuv_offset, sizeof(frame->yuv_offset));
+    frame->generation = frame_generation;
+}
+
+// Draw frame with shader through quad_vao (vertices already set). The
+// shader must have been linked on the current context's thread.
+static void draw_render_frame(const struct render_frame *frame, const struct frame_shader *shader, GLuint quad_vao) {
+    // Use shader program
+    glUseProgram(shader->program);
+
+    // Bind texture from smart manager
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, frame->texture);
+
+    // CHANGED 2026-10-16 - Bind chroma planes and conversion for YUV frames - Problem: colorspace conversion moved from videoconvert to the shader
+    GLint yuv_mode = frame->format == FRAME_FORMAT_NV12 ? 1 :
+                     frame->format == FRAME_FORMAT_I420 ? 2 : 0;
+    glUniform1i(shader->yuv_mode, yuv_mode);
+    if (yuv_mode != 0) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, frame->chroma[0]);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, frame->chroma[1]);
+        glUniformMatrix3fv(shader->yuv_to_rgb, 1, GL_FALSE, frame->yuv_matrix);
+        glUniform3fv(shader->yuv_offset, 1, frame->yuv_offset);
+        glActiveTexture(GL_TEXTURE0);
     }
-    
-    if (should_render) {
-        if (VERBOSE == 2) {
-            static int process_count = 0;
-            process_count++;
-            if (process_count % 100 == 0)  // Log every 100th frame
-                cflp_info("Processing new video frame: %dx%d, data=%p (frame %d)", 
-                         video_frame_data.width, video_frame_data.height, video_frame_data.data, process_count);
-        }
-        
-        // Check OpenGL error before texture update
-        GLenum err_before = glGetError();
-        if (err_before != GL_NO_ERROR && VERBOSE)
-            cflp_info("OpenGL error before texture update: 0x%x", err_before);
-        
-        // CHANGED 2026-07-08 - Route upload through PBO helper - Problem: direct upload stalled the render thread
+
+    // Draw the quad
+    glBindVertexArray(quad_vao);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    glBindVertexArray(0);
+
+    // Clean up
+    glUseProgram(0);
+    if (yuv_mode != 0) {
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Respecify the managed texture from compressed cache blocks. They are a
+// quarter to an eighth of the RGBA size, so they go up directly, without PBO
+// staging. Caller holds video_mutex and has a context current.
+static void upload_compressed_frame_locked(void) {
+    init_plane_texture(texture_manager.texture);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glCompressedTexImage2D(GL_TEXTURE_2D, 0, video_frame_data.compressed_format,
+                           video_frame_data.width, video_frame_data.height, 0,
+                           (GLsizei)video_frame_data.size, video_frame_data.data);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    texture_manager.compressed = TRUE;
+    texture_manager.current_width = video_frame_data.width;
+    texture_manager.current_height = video_frame_data.height;
+    texture_manager.initialized = TRUE;
+}
+
+// Move the pending decoded frame into texture_manager. Caller holds
+// video_mutex and has a context current; has_new_frame must be set.
+static void upload_pending_frame_locked(void) {
+    // Check OpenGL error before texture update
+    GLenum err_before = glGetError();
+    if (err_before != GL_NO_ERROR && VERBOSE)
+        cflp_info("OpenGL error before texture update: 0x%x", err_before);
+
+    // CHANGED 2026-07-08 - Route upload through PBO helper - Problem: direct upload stalled the render thread
+    // CHANGED 2026-10-16 - DMA-BUF frames are imported, not uploaded - Problem: zero-copy path for --upload dmabuf
+    // CHANGED 2026-10-16 - Textures follow the frame's pixel layout - Problem: NV12/I420 frames are uploaded as planes
+    set_texture_format(video_frame_data.is_dmabuf || video_frame_data.is_glmemory ?
+                       FRAME_FORMAT_RGBA : video_frame_data.format);
+    if (video_frame_data.is_glmemory) {
+        // Nothing to upload: wait for GStreamer's GL thread to finish
+        // writing the texture, then display it until the next frame
+        GstGLSyncMeta *sync_meta = gst_buffer_get_gl_sync_meta(video_frame_data.buffer);
+        if (sync_meta)
+            gst_gl_sync_meta_wait(sync_meta, gst_gl.app_context);
+        release_dmabuf_import();
+        release_gl_frame();
+        texture_manager.gl_buffer = video_frame_data.buffer;
+        texture_manager.gl_map = video_frame_data.map;
+        texture_manager.gl_texture = video_frame_data.gl_texture;
+        texture_manager.current_width = video_frame_data.width;
+        texture_manager.current_height = video_frame_data.height;
+        texture_manager.initialized = TRUE;
+        // Ownership moved to texture_manager
+        video_frame_data.buffer = NULL;
+        video_frame_data.is_glmemory = FALSE;
+    } else if (video_frame_data.is_dmabuf) {
+        release_gl_frame();
         GLuint current_texture = get_texture_for_dimensions(video_frame_data.width, video_frame_data.height);
-        upload_frame_to_texture(current_texture, video_frame_data.data, video_frame_data.size,
-                                video_frame_data.width, video_frame_data.height);
-        
-        // Check OpenGL error after texture update
-        GLenum err_after = glGetError();
-        if (err_after != GL_NO_ERROR)
-            cflp_info("OpenGL error after texture update: 0x%x", err_after);
-        
-        // CHANGED 2026-07-08 - Release mapped buffer ref instead of freeing heap copy - Problem: hot-path frames are now borrowed from GStreamer, not owned allocations
-        release_video_frame_locked();
-        
-        // Update last render time
-        last_render_time = current_time;
-        
-        if (VERBOSE == 2) {
-            static int texture_count = 0;
-            texture_count++;
-            if (texture_count % 100 == 0)  // Log every 100th frame
-                cflp_info("Updated video texture %u with %dx%d frame (update %d)", texture_manager.texture, texture_manager.current_width, texture_manager.current_height, texture_count);
-        }
-    } else if ((texture_manager.initialized && texture_manager.texture != 0 && time_since_last_render >= target_frame_time_ns) ||
-               transition_state.active) {
-        // No new frame, but we should still render the existing texture at target frame rate
-        // OR we're in a transition and need continuous rendering
-        if (VERBOSE == 2 && !transition_state.active) {
-            static int render_only_count = 0;
-            render_only_count++;
-            if (render_only_count % 100 == 0)
-                cflp_info("Rendering existing texture (render-only %d)", render_only_count);
+        if (!import_dmabuf_frame_locked(current_texture)) {
+            static bool import_warned = false;
+            if (!import_warned) {
+                cflp_warning("EGLImage import of DMA-BUF frame failed, uploading through a CPU mapping");
+                import_warned = true;
+            }
+            upload_dmabuf_frame_mapped_locked();
         }
-        // Update last render time
-        last_render_time = current_time;
+    } else if (video_frame_data.compressed_format) {
+        release_dmabuf_import();
+        release_gl_frame();
+        upload_compressed_frame_locked();
     } else {
-        if (VERBOSE == 2)
-            cflp_info("No new video frame available (frame rate limited)");
+        // Never write client memory into an imported DMA-BUF
+        release_dmabuf_import();
+        release_gl_frame();
+        get_texture_for_dimensions(video_frame_data.width, video_frame_data.height);
+        upload_frame_to_texture(video_frame_data.data, video_frame_data.size,
+                                video_frame_data.width, video_frame_data.height,
+                                video_frame_data.plane_offset, video_frame_data.plane_stride);
+        if (video_frame_data.format != FRAME_FORMAT_RGBA)
+            update_yuv_coefficients(video_frame_data.color_matrix, video_frame_data.color_range);
+    }
+
+    // Check OpenGL error after texture update
+    GLenum err_after = glGetError();
+    if (err_after != GL_NO_ERROR)
+        cflp_info("OpenGL error after texture update: 0x%x", err_after);
+
+    // CHANGED 2026-07-08 - Release mapped buffer ref instead of freeing heap copy - Problem: hot-path frames are now borrowed from GStreamer, not owned allocations
+    release_video_frame_locked();
+}
+
+// Link a frame shader on the current context and look up its uniforms. The
+// samplers always read units 0-2, so they are set once here.
+static bool link_frame_shader(struct frame_shader *shader) {
+    shader->program = create_shader_program();
+    if (shader->program == 0)
+        return false;
+    glUseProgram(shader->program);
+    glUniform1i(glGetUniformLocation(shader->program, "ourTexture"), 0);
+    glUniform1i(glGetUniformLocation(shader->program, "chromaTexture0"), 1);
+    glUniform1i(glGetUniformLocation(shader->program, "chromaTexture1"), 2);
+    glUseProgram(0);
+    shader->yuv_mode = glGetUniformLocation(shader->program, "yuvMode");
+    shader->yuv_to_rgb = glGetUniformLocation(shader->program, "yuvToRgb");
+    shader->yuv_offset = glGetUniformLocation(shader->program, "yuvOffset");
+    return true;
+}
+
+// Create the main loop's frame_shader on first use
+static bool ensure_shader_program(void) {
+    if (frame_shader.program != 0)
+        return true;
+    if (!link_frame_shader(&frame_shader)) {
+        cflp_error("Failed to create shader program");
+        return false;
+    }
+    if (VERBOSE)  // Keep this as it's a one-time message
+        cflp_info("Created shader program %u", frame_shader.program);
+    return true;
+}
+
+// A video frame is about to be committed together with a frame callback
+static void visibility_frame_requested(struct display_output *output) {
+    pthread_mutex_lock(&visibility.lock);
+    if (!output->frame_request_ns)
+        output->frame_request_ns = monotonic_ns();
+    pthread_mutex_unlock(&visibility.lock);
+}
+
+// Any frame callback on output; main loop or render thread
+static void visibility_frame_done(struct display_output *output) {
+    pthread_mutex_lock(&visibility.lock);
+    output->frame_request_ns = 0;
+    bool wake = visibility.suspended && !visibility.wake;
+    if (wake) {
+        visibility.wake = true;
+        visibility.wake_ns = monotonic_ns();
+    }
+    pthread_mutex_unlock(&visibility.lock);
+    // Render threads dispatch their own queue; make sure the main loop looks
+    if (wake && !wake_main_loop() && VERBOSE == 2)
+        cflp_warning("Failed to wake main loop for visibility change");
+}
+
+// A frame of the given generation was swapped: ends a resume latency measurement
+static void visibility_frame_shown(uint64_t generation) {
+    pthread_mutex_lock(&visibility.lock);
+    if (!visibility.measuring || generation <= visibility.wake_generation) {
+        pthread_mutex_unlock(&visibility.lock);
+        return;
+    }
+    visibility.measuring = false;
+    int64_t latency = monotonic_ns() - visibility.wake_ns;
+    pthread_mutex_unlock(&visibility.lock);
+
+    pthread_mutex_lock(&render_stats.lock);
+    render_stats.resume_ns = latency;
+    pthread_mutex_unlock(&render_stats.lock);
+    if (VERBOSE)
+        cflp_info("Visible again: first new frame on screen after %.1f ms", latency / 1e6);
+}
+
+// How long a frame callback may stay unanswered before output counts as hidden:
+// two refreshes, or one frame of the capped video if that is longer
+static int64_t visibility_starve_ns(const struct display_output *output) {
+    int64_t refresh = output->refresh_ns > 0 ? output->refresh_ns :
+                      output->refresh_mhz > 0 ? 1000000000000LL / output->refresh_mhz : 16666667;
+    pthread_mutex_lock(&frame_pacing.lock);
+    int64_t frame = target_frame_time_ns;
+    pthread_mutex_unlock(&frame_pacing.lock);
+    return MAX(2 * refresh, frame);
+}
+
+static void set_visibility_suspended(bool suspend) {
+    if (suspend) {
+        halt_info.is_paused++;
+        gst_element_set_state(pipeline, GST_STATE_PAUSED);
+        count_render_stat(&render_stats.suspends);
+    } else {
+        if (halt_info.is_paused > 0)
+            halt_info.is_paused--;
+        // The pipeline stays prerolled while paused, so this resumes where it stopped
+        if (!halt_info.is_paused)
+            gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    }
+}
+
+// Main loop, every iteration: suspend or resume playback and return how many
+// milliseconds until the next output could count as hidden (-1 = no deadline).
+static int update_visibility(struct wl_state *state) {
+    bool tracking = halt_info.auto_pause || visibility.idle_timeout_ms;
+    if (!tracking || !pipeline || is_image_mode || using_waylandsink)
+        return -1;
+
+    int64_t now = monotonic_ns();
+    int64_t next_deadline = -1;
+    int shown = 0;
+    struct display_output *output;
+    pthread_mutex_lock(&visibility.lock);
+    wl_list_for_each(output, &state->outputs, link) {
+        if (!output->layer_surface || !output->egl_surface)
+            continue;
+        int64_t deadline = output->frame_request_ns ? output->frame_request_ns + visibility_starve_ns(output) : -1;
+        if (deadline < 0 || deadline > now) {
+            shown++;
+            if (deadline > 0 && halt_info.auto_pause && (next_deadline < 0 || deadline < next_deadline))
+                next_deadline = deadline;
+        }
+    }
+
+    bool hidden = (halt_info.auto_pause && shown == 0) || visibility.idle;
+    bool suspend = !visibility.suspended && hidden;
+    bool resume = visibility.suspended && (visibility.wake || !hidden) && !visibility.idle;
+    if (suspend) {
+        visibility.suspended = true;
+        visibility.wake = false;
+        visibility.measuring = false;
+    } else if (resume) {
+        if (!visibility.wake)
+            visibility.wake_ns = now;  // woken by ext-idle-notify rather than a callback
+        visibility.suspended = false;
+        visibility.wake = false;
+        visibility.measuring = true;
+        visibility.wake_generation = frame_generation;
+        // Outputs still waiting on an old callback count as shown again
+        wl_list_for_each(output, &state->outputs, link)
+            output->frame_request_ns = 0;
+    }
+    pthread_mutex_unlock(&visibility.lock);
+
+    if (suspend) {
+        if (VERBOSE)
+            cflp_info(visibility.idle ? "Pausing because the seat is idle" : "Pausing because clappie is hidden");
+        set_visibility_suspended(true);
+        return -1;
+    }
+    if (resume) {
+        if (VERBOSE)
+            cflp_info("Resuming because clappie is visible");
+        set_visibility_suspended(false);
+        wl_list_for_each(output, &state->outputs, link)
+            output->redraw_needed = true;
+    }
+    if (next_deadline < 0)
+        return -1;
+    return (int)((next_deadline - now + 999999) / 1000000);
+}
+
+// Feedback is dispatched on the main queue even when a render thread swapped,
+// so outputs are looked up by wl_name rather than trusting a pointer that
+// may have been destroyed in between.
+static void presentation_feedback_sync_output(void *data, struct wp_presentation_feedback *feedback,
+                                              struct wl_output *wl_output) {
+    (void)data; (void)feedback; (void)wl_output;
+}
+
+static void presentation_feedback_presented(void *data, struct wp_presentation_feedback *feedback,
+                                            uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+                                            uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags) {
+    (void)seq_hi; (void)seq_lo;
+    uint32_t wl_name = (uint32_t)(uintptr_t)data;
+    wp_presentation_feedback_destroy(feedback);
+
+    int64_t present_ns = (int64_t)((((uint64_t)tv_sec_hi << 32) | tv_sec_lo) * 1000000000ULL) + tv_nsec;
+    // refresh is only a nominal interval on a fixed-rate mode; VRR has no grid to align to
+    int64_t refresh_ns = (flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC) ? (int64_t)refresh : 0;
+
+    const char *name = "unknown output";
+    struct display_output *output;
+    wl_list_for_each(output, &global_state->outputs, link) {
+        if (output->wl_name != wl_name)
+            continue;
+        output->present_ns = present_ns;
+        output->refresh_ns = refresh_ns;
+        if (output->name)
+            name = output->name;
+        break;
+    }
+
+    pthread_mutex_lock(&frame_pacing.lock);
+    if (frame_pacing.output_name == wl_name || frame_pacing.refresh_ns == 0 ||
+        (refresh_ns > 0 && refresh_ns < frame_pacing.refresh_ns)) {
+        if (VERBOSE && refresh_ns > 0 && refresh_ns != frame_pacing.refresh_ns)
+            cflp_info("Frame pacing aligned to %s vblanks (%.2f Hz)", name, 1e9 / refresh_ns);
+        frame_pacing.output_name = wl_name;
+        frame_pacing.last_present_ns = present_ns;
+        frame_pacing.refresh_ns = refresh_ns;
+    }
+    pthread_mutex_unlock(&frame_pacing.lock);
+}
+
+static void presentation_feedback_discarded(void *data, struct wp_presentation_feedback *feedback) {
+    (void)data;
+    wp_presentation_feedback_destroy(feedback);
+}
+
+static const struct wp_presentation_feedback_listener presentation_feedback_listener = {
+    .sync_output = presentation_feedback_sync_output,
+    .presented = presentation_feedback_presented,
+    .discarded = presentation_feedback_discarded,
+};
+
+// Ask when the next commit on output reaches the screen; call before swapping
+static void request_presentation_feedback(struct display_output *output) {
+    if (!global_state || !global_state->presentation || !frame_pacing.clock_monotonic)
+        return;
+    struct wp_presentation_feedback *feedback =
+        wp_presentation_feedback(global_state->presentation, output->surface);
+    if (feedback)
+        wp_presentation_feedback_add_listener(feedback, &presentation_feedback_listener,
+                                              (void *)(uintptr_t)output->wl_name);
+}
+
+// Present output's back buffer. When only the video quad can have changed
+// (same rect as the last swap, letterbox bars untouched) just that rect is
+// reported as damaged, so the compositor can skip recompositing the rest.
+static bool swap_output_buffers(struct display_output *output, bool full_damage) {
+    request_presentation_feedback(output);
+
+    int width = output->width * output->scale;
+    int height = output->height * output->scale;
+    int rect_width = MIN(width, (int)(width * output->quad_scale_x + 0.5f));
+    int rect_height = MIN(height, (int)(height * output->quad_scale_y + 0.5f));
+    EGLint rect[4] = { (width - rect_width) / 2, (height - rect_height) / 2, rect_width, rect_height };
+
+    bool partial = egl_swap_with_damage && !full_damage &&
+                   (rect_width < width || rect_height < height) &&
+                   memcmp(rect, output->damage_rect, sizeof(rect)) == 0;
+    memcpy(output->damage_rect, rect, sizeof(rect));
+
+    EGLBoolean ok = partial ? egl_swap_with_damage(egl_display, output->egl_surface, rect, 1) :
+                              eglSwapBuffers(egl_display, output->egl_surface);
+    if (ok) {
+        count_render_stat(&render_stats.swaps);
+        if (partial)
+            count_render_stat(&render_stats.partial_swaps);
+    }
+    return ok;
+}
+
+// Upload stage: move a pending decoded frame into texture_manager and bump
+// frame_generation. Runs once per frame no matter how many outputs draw it.
+static bool upload_frame_stage(void) {
+    // A pending image change completes here, while video_frame_data still holds its pixels
+    poll_image_load();
+
+    pthread_mutex_lock(&video_mutex);
+    if (!video_frame_data.has_new_frame) {
+        pthread_mutex_unlock(&video_mutex);
+        return false;
     }
+    if (!eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context)) {
+        pthread_mutex_unlock(&video_mutex);
+        cflp_error("Failed to make upload context current");
+        return false;
+    }
+
+    if (VERBOSE == 2) {
+        static int process_count = 0;
+        process_count++;
+        if (process_count % 100 == 0)  // Log every 100th frame
+            cflp_info("Processing new video frame: %dx%d, data=%p (frame %d)",
+                     video_frame_data.width, video_frame_data.height, video_frame_data.data, process_count);
+    }
+
+    bool loop_start = video_frame_data.loop_start;
+    video_frame_data.loop_start = FALSE;
+    upload_pending_frame_locked();
     // CHANGED 2026-07-09 - Unlock before transition/draw work; drawing reads texture_manager (render-thread-owned), not video_frame_data - Problem: holding video_mutex across the GL pass blocked the GStreamer streaming thread for the whole render
     pthread_mutex_unlock(&video_mutex);
 
+    frame_generation++;
+    frames_skipped = 0;
+    count_render_stat(&render_stats.uploads);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (last_render_time.tv_sec || last_render_time.tv_nsec)
+        record_upload_interval((now.tv_sec - last_render_time.tv_sec) * 1000000000LL +
+                               (now.tv_nsec - last_render_time.tv_nsec), loop_start);
+    last_render_time = now;
+
+    transition_frame_arrived();
+    if (video_switch_ns) {
+        if (VERBOSE)
+            cflp_success("New video on screen %.0f ms after the switch",
+                         (monotonic_ns() - video_switch_ns) / 1e6);
+        video_switch_ns = 0;
+    }
+
+    if (VERBOSE == 2) {
+        static int texture_count = 0;
+        texture_count++;
+        if (texture_count % 100 == 0)  // Log every 100th frame
+            cflp_info("Updated video texture %u with %dx%d frame (generation %llu)", texture_manager.texture,
+                     texture_manager.current_width, texture_manager.current_height,
+                     (unsigned long long)frame_generation);
+    }
+    return true;
+}
+
+static void render(struct display_output *output) {
+    // If using waylandsink, we don't need EGL rendering - waylandsink handles it
+    if (using_waylandsink) {
+        // Just schedule the next frame callback
+        output->frame_callback = wl_surface_frame(output->surface);
+        wl_callback_add_listener(output->frame_callback, &wl_surface_frame_listener, output);
+        output->redraw_needed = false;
+        return;
+    }
+
+    // CHANGED 2026-10-16 - Upload once per decoded frame, then draw per output - Problem: whichever output came
+    // first in the list consumed has_new_frame; the others redrew the shared texture only by timing luck
+    upload_frame_stage();
+
+    // Draw stage: an output already presenting the current frame keeps it, unless a redraw
+    // was requested explicitly or a transition is animating
+    if (!output->redraw_needed && !transition_state.active && texture_manager.initialized &&
+        output->presented_generation == frame_generation) {
+        count_render_stat(&render_stats.swaps_skipped);
+        return;
+    }
+
+    // Make sure we have a valid context
+    if (!eglMakeCurrent(egl_display, output->egl_surface, output->egl_surface, egl_context)) {
+        cflp_error("Failed to make output surface current");
+        return;
+    }
+
+    glViewport(0, 0, output->width * output->scale, output->height * output->scale);
+    
+    // Clear with black background
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // Update transition progress if active
+    update_transition();
+
     // Check if we're in a transition - render transition if active
     if (transition_state.active) {
         if (VERBOSE == 2)
             cflp_info("Rendering transition frame (progress=%.2f, alpha_new=%.2f)", 
                      transition_state.progress, transition_state.alpha_new);
         
-        // Create VAO and VBO if needed (shared with normal rendering)
-        if (vao == 0) {
-            glGenVertexArrays(1, &vao);
-            glGenBuffers(1, &vbo);
-            
-            glBindVertexArray(vao);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            
-            // Position attribute
-            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-            glEnableVertexAttribArray(0);
-            
-            // Texture coordinate attribute
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-            glEnableVertexAttribArray(1);
-            
-            glBindVertexArray(0);
-            
-            if (VERBOSE)
-                cflp_info("Created VAO %u and VBO %u", vao, vbo);
-        }
-        
-        // Update vertex data for new texture dimensions
-        update_vertex_data(output);
-        
-        // Render transition blend
+        // Render transition blend (sets up its own quads)
         render_transition(output);
     }
     // Render video texture if available (normal rendering when not transitioning)
@@ -1272,59 +2516,19 @@ static void render(struct display_output *output) {
         // Don't clear again - we want to see the video texture
         
         // Create shader program if needed
-        if (shader_program == 0) {
-            shader_program = create_shader_program();
-            if (shader_program == 0) {
-                cflp_error("Failed to create shader program");
-                return;
-            }
-            if (VERBOSE)  // Keep this as it's a one-time message
-                cflp_info("Created shader program %u", shader_program);
-        }
+        if (!ensure_shader_program())
+            return;
         
         // Create VAO and VBO if needed
-        if (vao == 0) {
-            glGenVertexArrays(1, &vao);
-            glGenBuffers(1, &vbo);
-            
-            glBindVertexArray(vao);
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            
-            // Position attribute
-            glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-            glEnableVertexAttribArray(0);
-            
-            // Texture coordinate attribute
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-            glEnableVertexAttribArray(1);
-            
-            glBindVertexArray(0);
-            
-            if (VERBOSE)  // Keep this as it's a one-time message
-                cflp_info("Created VAO %u and VBO %u", vao, vbo);
-        }
+        if (vao == 0)
+            create_quad_buffers(&vao, &vbo);
         
         // Update vertex data based on current video dimensions and scaling options
         update_vertex_data(output);
         
-        // Use shader program
-        glUseProgram(shader_program);
-        
-        // Bind texture from smart manager
-        glActiveTexture(GL_TEXTURE0);
-        // CHANGED 2026-07-09 - Read dimensions from texture_manager, not video_frame_data - Problem: this now runs outside video_mutex; texture_manager is render-thread-owned
-        GLuint render_texture = get_texture_for_dimensions(texture_manager.current_width, texture_manager.current_height);
-        glBindTexture(GL_TEXTURE_2D, render_texture);
-        glUniform1i(glGetUniformLocation(shader_program, "ourTexture"), 0);
-        
-        // Draw the quad
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-        glBindVertexArray(0);
-        
-        // Clean up
-        glUseProgram(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        struct render_frame frame;
+        snapshot_render_frame(&frame);
+        draw_render_frame(&frame, &frame_shader, vao);
         
         if (VERBOSE == 2) {
             static int complete_count = 0;
@@ -1338,8 +2542,22 @@ static void render(struct display_output *output) {
     }
 
     // Display frame first (must be done before creating frame callback)
-    if (!eglSwapBuffers(egl_display, output->egl_surface))
+    // CHANGED 2026-10-16 - Partial damage for unchanged letterbox bars - Problem: every swap damaged the whole output
+    bool drew_video = !transition_state.active && texture_manager.initialized && texture_manager.texture != 0;
+    // CHANGED 2026-10-16 - Pace video on this output's frame callback, committed with the buffer - Problem: with
+    // swap interval 0 every decoded frame was drawn on arrival, even above the output's refresh rate
+    if (drew_video) {
+        if (output->frame_callback)
+            wl_callback_destroy(output->frame_callback);
+        output->frame_callback = wl_surface_frame(output->surface);
+        wl_callback_add_listener(output->frame_callback, &wl_surface_frame_listener, output);
+        visibility_frame_requested(output);
+    }
+    if (!swap_output_buffers(output, !drew_video))
         cflp_error("Failed to swap egl buffers");
+    output->presented_generation = frame_generation;
+    if (drew_video)
+        visibility_frame_shown(frame_generation);
 
     // Create frame callback for next frame
     // During transitions, we always want a callback to ensure continuous rendering
@@ -1371,7 +2589,7 @@ static void render(struct display_output *output) {
         if (global_state && global_state->display) {
             wl_display_flush(global_state->display);
         }
-    } else {
+    } else if (!drew_video) {
         // No callback needed - clear any existing one
         if (output->frame_callback) {
             wl_callback_destroy(output->frame_callback);
@@ -1389,6 +2607,7 @@ static void frame_handle_done(void *data, struct wl_callback *callback, uint32_t
 
     // Display is ready for new frame
     output->frame_callback = NULL;
+    visibility_frame_done(output);
 
     // Reset deadman switch timer
     halt_info.frame_ready = 1;
@@ -1397,7 +2616,7 @@ static void frame_handle_done(void *data, struct wl_callback *callback, uint32_t
     // Always render if transition is active or redraw is needed
     // During transitions, this creates a continuous render loop:
     // render() -> frame_callback -> frame_handle_done() -> render() -> ...
-    if (transition_state.active || output->redraw_needed) {
+    if (transition_state.active || output->redraw_needed || output->presented_generation != frame_generation) {
         if (VERBOSE == 2)
             cflp_info("%s frame callback: rendering next frame", output->name);
         render(output);
@@ -1408,6 +2627,301 @@ const static struct wl_callback_listener wl_surface_frame_listener = {
     .done = frame_handle_done,
 };
 
+static void render_thread_frame_done(void *data, struct wl_callback *callback, uint32_t frame_time) {
+    (void)frame_time;
+    struct render_thread *rt = data;
+    rt->frame_done = true;
+    wl_callback_destroy(callback);
+    visibility_frame_done(rt->output);
+
+    // Reset deadman switch timer
+    halt_info.frame_ready = 1;
+}
+
+const static struct wl_callback_listener render_thread_frame_listener = {
+    .done = render_thread_frame_done,
+};
+
+static bool render_thread_stopping(struct render_thread *rt) {
+    pthread_mutex_lock(&render_threads.lock);
+    bool stop = rt->stop;
+    pthread_mutex_unlock(&render_threads.lock);
+    return stop;
+}
+
+// Read and dispatch this thread's event queue, waking early on stop_fd.
+// Uses the prepare/read protocol so the main loop can read concurrently.
+static void render_thread_dispatch(struct render_thread *rt) {
+    struct wl_display *display = global_state->display;
+    while (wl_display_prepare_read_queue(display, rt->queue) != 0)
+        wl_display_dispatch_queue_pending(display, rt->queue);
+    wl_display_flush(display);
+
+    struct pollfd fds[2] = {
+        { .fd = wl_display_get_fd(display), .events = POLLIN },
+        { .fd = rt->stop_fd, .events = POLLIN },
+    };
+    if (poll(fds, 2, -1) > 0 && (fds[0].revents & POLLIN))
+        wl_display_read_events(display);
+    else
+        wl_display_cancel_read(display);
+    wl_display_dispatch_queue_pending(display, rt->queue);
+}
+
+// Draw the newest published frame whenever this output's previous frame
+// callback has fired. Never touches texture_manager or video_frame_data.
+static void *render_thread_main(void *data) {
+    struct render_thread *rt = data;
+    struct display_output *output = rt->output;
+
+    if (!eglMakeCurrent(egl_display, output->egl_surface, output->egl_surface, rt->context)) {
+        cflp_error("Failed to make render context current for %s", output->name);
+        return NULL;
+    }
+    eglSwapInterval(egl_display, 0);
+    glDrawBuffer(GL_BACK);
+
+    // VAOs are not shared between contexts
+    GLuint quad_vao = 0, quad_vbo = 0;
+    create_quad_buffers(&quad_vao, &quad_vbo);
+    uint64_t presented = 0;
+
+    // Programs are shared, but so are their uniform values: a program of our own
+    // keeps this output's uniforms from racing the other threads'
+    struct frame_shader shader = {0};
+    if (!link_frame_shader(&shader))
+        cflp_error("Failed to create shader program for %s", output->name);
+
+    while (true) {
+        struct render_frame frame;
+        pthread_mutex_lock(&render_threads.lock);
+        while (!rt->stop && (render_threads.uploading || render_threads.generation == presented))
+            pthread_cond_wait(&render_threads.cond, &render_threads.lock);
+        if (rt->stop) {
+            pthread_mutex_unlock(&render_threads.lock);
+            break;
+        }
+        presented = render_threads.generation;
+        frame = render_threads.frame;
+        // Server-side wait: our GL commands queue behind the upload
+        if (render_threads.upload_fence)
+            render_threads.wait_sync(egl_display, render_threads.upload_fence, 0);
+        rt->drawing = true;
+        pthread_mutex_unlock(&render_threads.lock);
+
+        glViewport(0, 0, output->width * output->scale, output->height * output->scale);
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        update_quad_vertices(output, quad_vbo, frame.width, frame.height);
+        if (shader.program != 0)
+            draw_render_frame(&frame, &shader, quad_vao);
+
+        EGLSyncKHR fence = NULL;
+        if (render_threads.fence_sync)
+            fence = render_threads.create_sync(egl_display, EGL_SYNC_FENCE_KHR, NULL);
+        if (fence)
+            glFlush();
+        else
+            glFinish();
+
+        pthread_mutex_lock(&render_threads.lock);
+        if (rt->draw_fence)
+            render_threads.destroy_sync(egl_display, rt->draw_fence);
+        rt->draw_fence = fence;
+        rt->drawing = false;
+        pthread_cond_broadcast(&render_threads.cond);
+        pthread_mutex_unlock(&render_threads.lock);
+
+        // Pace on this output's own frame callback
+        rt->frame_done = false;
+        struct wl_callback *callback = wl_surface_frame(rt->surface_wrapper);
+        wl_callback_add_listener(callback, &render_thread_frame_listener, rt);
+        visibility_frame_requested(output);
+        if (!swap_output_buffers(output, false))
+            cflp_error("Failed to swap egl buffers for %s", output->name);
+        visibility_frame_shown(frame.generation);
+        while (!rt->frame_done && !render_thread_stopping(rt))
+            render_thread_dispatch(rt);
+        if (!rt->frame_done)
+            wl_callback_destroy(callback);
+    }
+
+    if (shader.program != 0)
+        glDeleteProgram(shader.program);
+    glDeleteBuffers(1, &quad_vbo);
+    glDeleteVertexArrays(1, &quad_vao);
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglReleaseThread();
+    return NULL;
+}
+
+static void start_render_thread(struct display_output *output) {
+    struct render_thread *rt = calloc(1, sizeof(*rt));
+    if (!rt)
+        return;
+    rt->output = output;
+    rt->context = eglCreateContext(egl_display, egl_config, egl_context, render_threads.context_attrib);
+    rt->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (rt->context == EGL_NO_CONTEXT || rt->stop_fd == -1) {
+        cflp_warning("Failed to set up a render thread for %s, rendering from the main loop", output->name);
+        render_threads.enabled = false;
+        if (rt->context != EGL_NO_CONTEXT)
+            eglDestroyContext(egl_display, rt->context);
+        if (rt->stop_fd != -1)
+            close(rt->stop_fd);
+        free(rt);
+        return;
+    }
+    rt->queue = wl_display_create_queue(global_state->display);
+    rt->surface_wrapper = wl_proxy_create_wrapper(output->surface);
+    wl_proxy_set_queue((struct wl_proxy *)rt->surface_wrapper, rt->queue);
+
+    // The surface can only be current on one thread
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context);
+    if (output->frame_callback) {
+        wl_callback_destroy(output->frame_callback);
+        output->frame_callback = NULL;
+    }
+
+    output->render_thread = rt;
+    if (pthread_create(&rt->thread, NULL, render_thread_main, rt) != 0) {
+        cflp_warning("Failed to start render thread for %s, rendering from the main loop", output->name);
+        render_threads.enabled = false;
+        output->render_thread = NULL;
+        wl_proxy_wrapper_destroy(rt->surface_wrapper);
+        wl_event_queue_destroy(rt->queue);
+        eglDestroyContext(egl_display, rt->context);
+        close(rt->stop_fd);
+        free(rt);
+        return;
+    }
+    if (VERBOSE)
+        cflp_info("Render thread started for %s", output->name);
+}
+
+// Join output's render thread; the main loop draws it again afterwards
+static void stop_render_thread(struct display_output *output) {
+    struct render_thread *rt = output->render_thread;
+    if (!rt)
+        return;
+
+    pthread_mutex_lock(&render_threads.lock);
+    rt->stop = true;
+    pthread_cond_broadcast(&render_threads.cond);
+    pthread_mutex_unlock(&render_threads.lock);
+    eventfd_write(rt->stop_fd, 1);
+    pthread_join(rt->thread, NULL);
+
+    output->render_thread = NULL;
+    if (rt->draw_fence)
+        render_threads.destroy_sync(egl_display, rt->draw_fence);
+    wl_proxy_wrapper_destroy(rt->surface_wrapper);
+    wl_event_queue_destroy(rt->queue);
+    eglDestroyContext(egl_display, rt->context);
+    close(rt->stop_fd);
+    free(rt);
+
+    output->redraw_needed = true;
+    if (VERBOSE)
+        cflp_info("Render thread stopped for %s", output->name);
+}
+
+static void stop_all_render_threads(void) {
+    if (!global_state)
+        return;
+    struct display_output *output;
+    wl_list_for_each(output, &global_state->outputs, link)
+        stop_render_thread(output);
+}
+
+// Start or stop render threads to match what is playing. Threads only
+// draw video; images and transitions stay on the main loop.
+static void sync_render_threads(struct wl_state *state) {
+    if (!render_threads.enabled)
+        return;
+    bool want = !is_image_mode && !using_waylandsink && !transition_state.active;
+    struct display_output *output;
+    wl_list_for_each(output, &state->outputs, link) {
+        if (want && !output->render_thread && output->egl_surface && output->width > 0)
+            start_render_thread(output);
+        else if (!want && output->render_thread)
+            stop_render_thread(output);
+    }
+}
+
+static bool render_threads_running(struct wl_state *state) {
+    struct display_output *output;
+    wl_list_for_each(output, &state->outputs, link) {
+        if (output->render_thread)
+            return true;
+    }
+    return false;
+}
+
+// Upload the pending frame once on the main context and publish it to
+// every render thread
+static void publish_render_frame(struct wl_state *state) {
+    pthread_mutex_lock(&video_mutex);
+    bool has_frame = video_frame_data.has_new_frame;
+    pthread_mutex_unlock(&video_mutex);
+    if (!has_frame)
+        return;
+
+    if (!eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, egl_context)) {
+        cflp_error("Failed to make upload context current");
+        return;
+    }
+    if (!ensure_shader_program())
+        return;
+
+    // Keep threads off the textures until the new frame is in place, and
+    // order the upload after their last draws
+    pthread_mutex_lock(&render_threads.lock);
+    render_threads.uploading = true;
+    struct display_output *output;
+    wl_list_for_each(output, &state->outputs, link) {
+        struct render_thread *rt = output->render_thread;
+        if (!rt)
+            continue;
+        while (rt->drawing)
+            pthread_cond_wait(&render_threads.cond, &render_threads.lock);
+        if (rt->draw_fence) {
+            // DMA-BUF and GL memory frames go back to GStreamer on release,
+            // so those need the draw finished on the CPU side too
+            if (texture_manager.egl_image || texture_manager.gl_buffer)
+                render_threads.client_wait_sync(egl_display, rt->draw_fence,
+                                                EGL_SYNC_FLUSH_COMMANDS_BIT_KHR, 100000000);
+            else
+                render_threads.wait_sync(egl_display, rt->draw_fence, 0);
+            render_threads.destroy_sync(egl_display, rt->draw_fence);
+            rt->draw_fence = NULL;
+        }
+    }
+    pthread_mutex_unlock(&render_threads.lock);
+
+    upload_frame_stage();
+
+    EGLSyncKHR fence = NULL;
+    if (render_threads.fence_sync)
+        fence = render_threads.create_sync(egl_display, EGL_SYNC_FENCE_KHR, NULL);
+    if (fence)
+        glFlush();
+    else
+        glFinish();
+
+    pthread_mutex_lock(&render_threads.lock);
+    if (render_threads.upload_fence)
+        render_threads.destroy_sync(egl_display, render_threads.upload_fence);
+    render_threads.upload_fence = fence;
+    if (texture_manager.initialized) {
+        snapshot_render_frame(&render_threads.frame);
+        render_threads.generation++;
+    }
+    render_threads.uploading = false;
+    pthread_cond_broadcast(&render_threads.cond);
+    pthread_mutex_unlock(&render_threads.lock);
+}
+
 // Save current state (maps to existing global variables)
 // CRITICAL: Must be called BEFORE GStreamer pipeline shutdown to avoid race conditions
 static void save_current_state(void) {
@@ -1733,123 +3247,246 @@ static void stop_slapper() {
     exit(EXIT_FAILURE);
 }
 
-// Thread helpers
-static void pthread_sleep(uint time) {
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-    sleep(time);
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+// Main loop timers
+// CHANGED 2026-10-16 - Auto-stop and watch lists run from the main poll() loop - Problem: each had
+// its own thread sleep-polling once a second, which woke the process even when idle, delayed
+// reactions by up to a second and needed cancellation-state juggling around every sleep.
+// They are now timerfd/procmon fds polled next to the Wayland, wakeup and IPC fds.
+static int create_loop_timer(void) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd < 0)
+        cflp_warning("Failed to create timer: %s", strerror(errno));
+    return fd;
 }
-static void pthread_usleep(uint time) {
-    pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-    usleep(time);
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-}
-
-// Process monitoring
-static char *check_watch_list(char **list) {
-
-    char pid_name[512] = {0};
 
-    for (uint i=0; list[i] != NULL; i++) {
-        snprintf(pid_name, sizeof(pid_name), "pidof %s > /dev/null", list[i]);
+// First expiry after first_ms, then every interval_ms (0 = once); first_ms 0 disarms
+static void arm_loop_timer(int fd, uint first_ms, uint interval_ms) {
+    struct itimerspec spec = {
+        .it_value = { first_ms / 1000, (first_ms % 1000) * 1000000L },
+        .it_interval = { interval_ms / 1000, (interval_ms % 1000) * 1000000L },
+    };
+    timerfd_settime(fd, 0, &spec, NULL);
+}
 
-        // Stop if program is open
-        if (!system(pid_name))
-            return list[i];
-    }
-    return NULL;
+// Read the counter of a readable timerfd or eventfd
+static void drain_loop_fd(int fd) {
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) == -1 && errno != EAGAIN && VERBOSE == 2)
+        cflp_warning("Failed to read main loop fd: %s", strerror(errno));
 }
 
-static void *monitor_pauselist(void *_) {
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-    bool list_paused = 0;
+// Process monitoring
+// CHANGED 2026-10-16 - Watch lists use procmon instead of `pidof` shell-outs - Problem: each list forked
+// a shell plus pidof per entry every second, so a stoplist entry took up to a second to react and
+// cost a fork/exec storm on long lists. Both lists are served from process events
+// (or one shared /proc scan per tick) and react within WATCH_LIST_TICK_MS.
+#define WATCH_LIST_TICK_MS 100
 
-    while (halt_info.pauselist) {
+static struct {
+    procmon_t *monitor;
+    int timer_fd;                  // /proc scan tick when process events are unavailable
+    bool paused;                   // The pauselist holds one count of halt_info.is_paused
+} watch_lists = { .timer_fd = -1 };
 
-        char *app = check_watch_list(halt_info.pauselist);
-        if (app && !list_paused && !halt_info.is_paused) {
+static void check_watch_lists(void) {
+    if (halt_info.stoplist) {
+        const char *app = procmon_find(watch_lists.monitor, halt_info.stoplist);
+        if (app) {
             if (VERBOSE)
-                cflp_info("Pausing for %s", app);
-            // For GStreamer, we pause the pipeline
-            if (pipeline)
-                gst_element_set_state(pipeline, GST_STATE_PAUSED);
-            list_paused = 1;
-            halt_info.is_paused += 1;
-        } else if (!app && list_paused) {
-            list_paused = 0;
-            if (halt_info.is_paused)
-                halt_info.is_paused -= 1;
-            // CHANGED 2026-02-21 04:30 - Resume pipeline when pauselist condition clears - Problem: playback could stay paused indefinitely after watched process exits
-            if (!halt_info.is_paused && pipeline)
-                gst_element_set_state(pipeline, GST_STATE_PLAYING);
+                cflp_info("Stopping for %s", app);
+            stop_slapper();
         }
+    }
 
-        pthread_sleep(1);
+    const char *app = halt_info.pauselist ? procmon_find(watch_lists.monitor, halt_info.pauselist) : NULL;
+    if (app && !watch_lists.paused && !halt_info.is_paused) {
+        if (VERBOSE)
+            cflp_info("Pausing for %s", app);
+        // For GStreamer, we pause the pipeline
+        if (pipeline)
+            gst_element_set_state(pipeline, GST_STATE_PAUSED);
+        watch_lists.paused = 1;
+        halt_info.is_paused += 1;
+    } else if (!app && watch_lists.paused) {
+        watch_lists.paused = 0;
+        if (halt_info.is_paused)
+            halt_info.is_paused -= 1;
+        // CHANGED 2026-02-21 04:30 - Resume pipeline when pauselist condition clears - Problem: playback could stay paused indefinitely after watched process exits
+        if (!halt_info.is_paused && pipeline)
+            gst_element_set_state(pipeline, GST_STATE_PLAYING);
     }
-    pthread_exit(NULL);
 }
 
-static void *monitor_stoplist(void *_) {
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-
-    while (halt_info.stoplist) {
+static void init_watch_lists(void) {
+    if (!halt_info.pauselist && !halt_info.stoplist)
+        return;
 
-        char *app = check_watch_list(halt_info.stoplist);
-        if (app) {
-            if (VERBOSE)
-                cflp_info("Stopping for %s", app);
-            stop_slapper();
-        }
+    char **const lists[] = { halt_info.pauselist, halt_info.stoplist };
+    watch_lists.monitor = procmon_create(lists, 2);
+    if (!watch_lists.monitor) {
+        cflp_error("Failed to start watch list monitor");
+        return;
+    }
 
-        pthread_sleep(1);
+    if (procmon_get_fd(watch_lists.monitor) >= 0) {
+        if (VERBOSE)
+            cflp_info("Watch lists follow process events");
+    } else {
+        if (VERBOSE)
+            cflp_info("Watch lists scan /proc every %d ms", WATCH_LIST_TICK_MS);
+        watch_lists.timer_fd = create_loop_timer();
+        if (watch_lists.timer_fd >= 0)
+            arm_loop_timer(watch_lists.timer_fd, WATCH_LIST_TICK_MS, WATCH_LIST_TICK_MS);
     }
-    pthread_exit(NULL);
+    check_watch_lists();
 }
 
-static void *handle_auto_pause(void *_) {
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+// Process events (or the scan tick) for the main loop to poll, -1 if none
+static int watch_lists_fd(void) {
+    if (!watch_lists.monitor)
+        return -1;
+    int fd = procmon_get_fd(watch_lists.monitor);
+    return fd >= 0 ? fd : watch_lists.timer_fd;
+}
 
-    while (halt_info.auto_pause) {
+static void handle_watch_lists(void) {
+    if (watch_lists.timer_fd >= 0)
+        drain_loop_fd(watch_lists.timer_fd);
+    procmon_update(watch_lists.monitor);
+    check_watch_lists();
+}
 
-        // Set deadman switch timer
-        halt_info.frame_ready = 0;
-        pthread_sleep(2);
-        if (!halt_info.frame_ready && !halt_info.is_paused) {
-            if (VERBOSE)
-                cflp_info("Pausing because clappie is hidden");
-            // For GStreamer, we pause the pipeline
-            if (pipeline)
-                gst_element_set_state(pipeline, GST_STATE_PAUSED);
-            halt_info.is_paused += 1;
-
-            while (!halt_info.frame_ready) {
-                pthread_usleep(10000);
-            }
-            if (halt_info.is_paused)
-                halt_info.is_paused -= 1;
-            // CHANGED 2026-02-21 04:30 - Resume pipeline after auto-pause hidden state clears - Problem: wallpaper could remain frozen after becoming visible again
-            if (!halt_info.is_paused && pipeline)
-                gst_element_set_state(pipeline, GST_STATE_PLAYING);
-        }
+// Auto-stop deadman switch: stop if no frame callback arrived during a whole period
+#define AUTO_STOP_PERIOD_MS 2000
+
+static int auto_stop_timer_fd = -1;
+
+static void init_auto_stop(void) {
+    if (!halt_info.auto_stop)
+        return;
+    auto_stop_timer_fd = create_loop_timer();
+    if (auto_stop_timer_fd < 0)
+        return;
+    halt_info.frame_ready = 0;
+    arm_loop_timer(auto_stop_timer_fd, AUTO_STOP_PERIOD_MS, AUTO_STOP_PERIOD_MS);
+}
+
+static void handle_auto_stop(void) {
+    drain_loop_fd(auto_stop_timer_fd);
+    if (!halt_info.frame_ready) {
+        if (VERBOSE)
+            cflp_info("Stopping because clappie is hidden");
+        stop_slapper();
     }
-    pthread_exit(NULL);
+    // Set deadman switch timer
+    halt_info.frame_ready = 0;
+}
+
+// Running time of buffer's PTS in the current segment, GST_CLOCK_TIME_NONE if it has none
+static GstClockTime buffer_running_time(GstPad *pad, GstBuffer *buffer) {
+    GstClockTime pts = GST_BUFFER_PTS(buffer);
+    if (!GST_CLOCK_TIME_IS_VALID(pts))
+        return GST_CLOCK_TIME_NONE;
+
+    GstEvent *segment_event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+    if (!segment_event)
+        return GST_CLOCK_TIME_NONE;
+    const GstSegment *segment;
+    gst_event_parse_segment(segment_event, &segment);
+    GstClockTime running_time = gst_segment_to_running_time(segment, GST_FORMAT_TIME, pts);
+    gst_event_unref(segment_event);
+    return running_time;
 }
 
-static void *handle_auto_stop(void *_) {
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+// Monotonic time at which a frame with running_time is due on screen, or -1 if it has no place on the clock
+static int64_t frame_due_monotonic_ns(GstPad *pad, GstClockTime running_time) {
+    if (!GST_CLOCK_TIME_IS_VALID(running_time))
+        return -1;
 
-    while (halt_info.auto_stop) {
+    GstElement *sink = gst_pad_get_parent_element(pad);
+    if (!sink)
+        return -1;
+    GstClock *clock = gst_element_get_clock(sink);
+    GstClockTime base_time = gst_element_get_base_time(sink);
+    gst_object_unref(sink);
+    if (!clock)
+        return -1;
 
-        // Set deadman switch timer
-        halt_info.frame_ready = 0;
-        pthread_sleep(2);
-        if (!halt_info.frame_ready) {
-            if (VERBOSE)
-                cflp_info("Stopping because clappie is hidden");
-            stop_slapper();
-        }
+    GstClockTime latency = pipeline ? gst_pipeline_get_latency(GST_PIPELINE(pipeline)) : GST_CLOCK_TIME_NONE;
+    GstClockTimeDiff until_due = GST_CLOCK_DIFF(gst_clock_get_time(clock),
+                                                base_time + running_time +
+                                                (GST_CLOCK_TIME_IS_VALID(latency) ? latency : 0));
+    gst_object_unref(clock);
+    return monotonic_ns() + until_due;
+}
+
+// CHANGED 2026-10-16 - Hold each video frame until just after the vblank before the one nearest its PTS -
+// Problem: the probe runs ahead of appsink's own clock wait, so frames reached render() up to a frame early
+// at whatever phase the streaming thread happened to run, and the vblank that showed them varied frame to frame.
+// Returns false if a flush arrived while waiting and the frame should be dropped.
+static bool pace_video_frame(GstPad *pad, GstClockTime running_time) {
+    GstElement *sink = gst_pad_get_parent_element(pad);
+    if (!sink)
+        return true;
+    bool playing = GST_STATE(sink) == GST_STATE_PLAYING;
+    gst_object_unref(sink);
+    if (!playing)
+        return true;  // preroll and paused seeks show the frame right away
+
+    int64_t due = frame_due_monotonic_ns(pad, running_time);
+    if (due < 0)
+        return true;
+
+    pthread_mutex_lock(&frame_pacing.lock);
+    int64_t deliver = due;
+    if (frame_pacing.refresh_ns > 0 && frame_pacing.last_present_ns > 0) {
+        // Vblank nearest to the due time on the reference output's grid; the frame is handed
+        // over right after the vblank before it, leaving a whole refresh to draw and commit
+        int64_t refresh = frame_pacing.refresh_ns;
+        int64_t since = due - frame_pacing.last_present_ns + refresh / 2;
+        int64_t vblank = frame_pacing.last_present_ns + (since >= 0 ? since / refresh : -((-since + refresh - 1) / refresh)) * refresh;
+        deliver = vblank - refresh + FRAME_PACING_MARGIN_NS;
+    }
+
+    int64_t now = monotonic_ns();
+    if (deliver - now > FRAME_PACING_MAX_WAIT_NS)
+        deliver = now + FRAME_PACING_MAX_WAIT_NS;
+
+    // Condition variables time out on CLOCK_REALTIME; convert the monotonic deadline
+    struct timespec realtime;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    int64_t deadline = (int64_t)realtime.tv_sec * 1000000000LL + realtime.tv_nsec + (deliver - now);
+    struct timespec abs = { .tv_sec = deadline / 1000000000LL, .tv_nsec = deadline % 1000000000LL };
+    while (!frame_pacing.flushing && monotonic_ns() < deliver) {
+        if (pthread_cond_timedwait(&frame_pacing.cond, &frame_pacing.lock, &abs) == ETIMEDOUT)
+            break;
+    }
+    bool flushing = frame_pacing.flushing;
+    pthread_mutex_unlock(&frame_pacing.lock);
+
+    if (VERBOSE == 2 && !flushing) {
+        static int paced_count = 0;
+        if (++paced_count % 100 == 0)  // Log every 100th frame
+            cflp_info("Frame paced: delivered %.2f ms before due", (due - monotonic_ns()) / 1e6);
     }
-    pthread_exit(NULL);
+    return !flushing;
+}
+
+// Wake a frame held by pace_video_frame() on seeks, loops and state changes that flush
+static GstPadProbeReturn frame_pacing_flush_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    (void)pad; (void)user_data;
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (!event)
+        return GST_PAD_PROBE_OK;
+    pthread_mutex_lock(&frame_pacing.lock);
+    if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_START) {
+        frame_pacing.flushing = true;
+        pthread_cond_broadcast(&frame_pacing.cond);
+    } else if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP) {
+        frame_pacing.flushing = false;
+    }
+    pthread_mutex_unlock(&frame_pacing.lock);
+    return GST_PAD_PROBE_OK;
 }
 
 // GStreamer event handling
@@ -1870,16 +3507,53 @@ static GstPadProbeReturn buffer_probe(GstPad *pad, GstPadProbeInfo *info, gpoint
     if (caps != cached_caps) {
         GstStructure *structure = gst_caps_get_structure(caps, 0);
         const gchar *format = gst_structure_get_string(structure, "format");
-        cached_is_rgba = (format && strcmp(format, "RGBA") == 0);
+        GstCapsFeatures *features = gst_caps_get_features(caps, 0);
+        // CHANGED 2026-10-16 - Recognise DMA-BUF RGBA caps - Problem: zero-copy path for --upload dmabuf
+        cached_is_dmabuf = features && gst_caps_features_contains(features, GST_CAPS_FEATURE_MEMORY_DMABUF);
+        cached_is_glmemory = features && gst_caps_features_contains(features, GST_CAPS_FEATURE_MEMORY_GL_MEMORY);
+        cached_drm_modifier = DRM_MODIFIER_INVALID;
+        // CHANGED 2026-10-16 - Accept NV12/I420 alongside RGBA - Problem: forcing RGBA made videoconvert do a full CPU colorspace conversion
+        cached_format = FRAME_FORMAT_UNSUPPORTED;
+        cached_info_valid = FALSE;
+        if (format && strcmp(format, "DMA_DRM") == 0) {
+            // drm-format is "FOURCC" or "FOURCC:0xMODIFIER"; AB24 is RGBA byte order
+            const gchar *drm_format = gst_structure_get_string(structure, "drm-format");
+            if (drm_format && strncmp(drm_format, "AB24", 4) == 0) {
+                cached_format = FRAME_FORMAT_RGBA;
+                if (drm_format[4] == ':')
+                    cached_drm_modifier = g_ascii_strtoull(drm_format + 5, NULL, 16);
+            }
+        } else if (format && gst_video_info_from_caps(&cached_info, caps)) {
+            cached_info_valid = TRUE;
+            switch (GST_VIDEO_INFO_FORMAT(&cached_info)) {
+                case GST_VIDEO_FORMAT_RGBA: cached_format = FRAME_FORMAT_RGBA; break;
+                case GST_VIDEO_FORMAT_NV12: cached_format = FRAME_FORMAT_NV12; break;
+                case GST_VIDEO_FORMAT_I420: cached_format = FRAME_FORMAT_I420; break;
+                default: break;
+            }
+        }
         cached_width = 0;
         cached_height = 0;
-        if (cached_is_rgba) {
+        if (cached_format != FRAME_FORMAT_UNSUPPORTED) {
             gst_structure_get_int(structure, "width", &cached_width);
             gst_structure_get_int(structure, "height", &cached_height);
+            int fps_num = 0, fps_den = 1;
+            if (!is_image_mode)
+                gst_structure_get_fraction(structure, "framerate", &fps_num, &fps_den);
+            set_content_frame_rate(fps_num, fps_den);
             if (VERBOSE == 2)
-                cflp_info("Caps negotiated: RGBA %dx%d", cached_width, cached_height);
+                cflp_info("Caps negotiated: %s %dx%d", format, cached_width, cached_height);
         } else if (VERBOSE == 2) {
-            cflp_info("Frame format is %s, not RGBA", format ? format : "unknown");
+            cflp_info("Frame format %s is not supported", format ? format : "unknown");
+        }
+        if (upload_mode != UPLOAD_MODE_COPY) {
+            static int logged_path = -1;
+            int path = cached_is_glmemory ? 2 : cached_is_dmabuf ? 1 : 0;
+            if (logged_path != path) {
+                cflp_info("Video upload path: %s", path == 2 ? "GL memory (shared context)" :
+                          path == 1 ? "DMA-BUF zero-copy (EGLImage import)" : "mapped system memory");
+                logged_path = path;
+            }
         }
         if (cached_caps)
             gst_caps_unref(cached_caps);
@@ -1888,10 +3562,86 @@ static GstPadProbeReturn buffer_probe(GstPad *pad, GstPadProbeInfo *info, gpoint
         gst_caps_unref(caps);
     }
 
-    if (cached_is_rgba && cached_width > 0 && cached_height > 0) {
+    // The stream restarting (segment seek, or the next decoder in gapless mode) sends PTS back
+    gboolean loop_start = FALSE;
+    if (!is_image_mode && cached_format != FRAME_FORMAT_UNSUPPORTED) {
+        count_render_stat(&render_stats.converted);
+        GstClockTime running_time = buffer_running_time(pad, buffer);
+        if (!frame_rate_admits(running_time) || !pace_video_frame(pad, running_time)) {
+            count_render_stat(&render_stats.capped);
+            return GST_PAD_PROBE_DROP;
+        }
+        if (GST_BUFFER_PTS_IS_VALID(buffer)) {
+            loop_start = GST_CLOCK_TIME_IS_VALID(probe_last_pts) && GST_BUFFER_PTS(buffer) < probe_last_pts;
+            probe_last_pts = GST_BUFFER_PTS(buffer);
+        }
+    }
+
+    if (cached_format == FRAME_FORMAT_RGBA && cached_is_glmemory && cached_width > 0 && cached_height > 0
+        && gst_is_gl_memory(gst_buffer_peek_memory(buffer, 0))) {
+        // Map for GL access: runs any pending transfer on GStreamer's GL thread
+        // and yields the texture id, valid on our shared context
+        GstMemory *mem = gst_buffer_peek_memory(buffer, 0);
+        GstMapInfo map;
+        if (gst_buffer_map(buffer, &map, GST_MAP_READ | GST_MAP_GL)) {
+            // Fence GStreamer's GL commands; render() waits on it before sampling
+            GstGLSyncMeta *sync_meta = gst_buffer_get_gl_sync_meta(buffer);
+            if (sync_meta)
+                gst_gl_sync_meta_set_sync_point(sync_meta, GST_GL_BASE_MEMORY_CAST(mem)->context);
+            gst_buffer_ref(buffer);
+
+            pthread_mutex_lock(&video_mutex);
+            release_video_frame_locked();
+            video_frame_data.buffer = buffer;
+            video_frame_data.map = map;
+            video_frame_data.is_glmemory = TRUE;
+            video_frame_data.gl_texture = *(guint *)map.data;
+            video_frame_data.width = cached_width;
+            video_frame_data.height = cached_height;
+            video_frame_data.has_new_frame = TRUE;
+            video_frame_data.loop_start |= loop_start;
+            if (is_image_mode)
+                image_frame_captured = true;
+            pthread_mutex_unlock(&video_mutex);
+
+            if (!wake_main_loop()) {
+                if (VERBOSE)
+                    cflp_warning("Failed to wake main loop");
+            }
+        }
+    } else if (cached_format == FRAME_FORMAT_RGBA && cached_is_dmabuf && cached_width > 0 && cached_height > 0
+        && gst_buffer_n_memory(buffer) == 1 && gst_is_dmabuf_memory(gst_buffer_peek_memory(buffer, 0))) {
+        // Hand the fd to render(); the buffer ref keeps it valid until import
+        GstMemory *mem = gst_buffer_peek_memory(buffer, 0);
+        GstVideoMeta *vmeta = gst_buffer_get_video_meta(buffer);
+        gst_buffer_ref(buffer);
+
+        pthread_mutex_lock(&video_mutex);
+        release_video_frame_locked();
+        video_frame_data.buffer = buffer;
+        video_frame_data.is_dmabuf = TRUE;
+        video_frame_data.dmabuf_fd = gst_dmabuf_memory_get_fd(mem);
+        video_frame_data.dmabuf_offset = mem->offset + (vmeta ? vmeta->offset[0] : 0);
+        video_frame_data.dmabuf_stride = vmeta ? vmeta->stride[0] : cached_width * 4;
+        video_frame_data.dmabuf_modifier = cached_drm_modifier;
+        video_frame_data.width = cached_width;
+        video_frame_data.height = cached_height;
+        video_frame_data.has_new_frame = TRUE;
+        video_frame_data.loop_start |= loop_start;
+        if (is_image_mode)
+            image_frame_captured = true;
+        pthread_mutex_unlock(&video_mutex);
+
+        if (!wake_main_loop()) {
+            if (VERBOSE)
+                cflp_warning("Failed to wake main loop");
+        }
+    } else if (cached_format != FRAME_FORMAT_UNSUPPORTED && cached_width > 0 && cached_height > 0) {
         // Retain and map the buffer for the render thread; no copy
         GstMapInfo map;
         if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+            // Decoders may pad planes; prefer per-buffer video meta over the caps layout
+            GstVideoMeta *vmeta = gst_buffer_get_video_meta(buffer);
             gst_buffer_ref(buffer);
 
             pthread_mutex_lock(&video_mutex);
@@ -1902,7 +3652,22 @@ static GstPadProbeReturn buffer_probe(GstPad *pad, GstPadProbeInfo *info, gpoint
             video_frame_data.size = map.size;
             video_frame_data.width = cached_width;
             video_frame_data.height = cached_height;
+            video_frame_data.format = cached_format;
+            for (int i = 0; i < 3; i++) {
+                if (vmeta && (guint)i < vmeta->n_planes) {
+                    video_frame_data.plane_offset[i] = vmeta->offset[i];
+                    video_frame_data.plane_stride[i] = vmeta->stride[i];
+                } else if (cached_info_valid) {
+                    video_frame_data.plane_offset[i] = GST_VIDEO_INFO_PLANE_OFFSET(&cached_info, i);
+                    video_frame_data.plane_stride[i] = GST_VIDEO_INFO_PLANE_STRIDE(&cached_info, i);
+                }
+            }
+            if (cached_info_valid) {
+                video_frame_data.color_matrix = cached_info.colorimetry.matrix;
+                video_frame_data.color_range = cached_info.colorimetry.range;
+            }
             video_frame_data.has_new_frame = TRUE;
+            video_frame_data.loop_start |= loop_start;
 
             // For image mode, mark frame as captured (single frame only)
             if (is_image_mode) {
@@ -1914,14 +3679,13 @@ static GstPadProbeReturn buffer_probe(GstPad *pad, GstPadProbeInfo *info, gpoint
                 static int frame_count = 0;
                 frame_count++;
                 if (frame_count % 100 == 0)  // Log every 100th frame
-                    cflp_info("Captured %dx%d RGBA frame for texture update (frame %d)", cached_width, cached_height, frame_count);
+                    cflp_info("Captured %dx%d frame for texture update (frame %d)", cached_width, cached_height, frame_count);
             }
 
-            // Trigger render via wakeup pipe to ensure thread safety
-            if (write(wakeup_pipe[1], "f", 1) == -1) {
-                // If pipe write fails, try to trigger directly
+            // Trigger render from the main loop to ensure thread safety
+            if (!wake_main_loop()) {
                 if (VERBOSE)
-                    cflp_warning("Failed to write to wakeup pipe");
+                    cflp_warning("Failed to wake main loop");
             }
         }
     }
@@ -1929,6 +3693,25 @@ static GstPadProbeReturn buffer_probe(GstPad *pad, GstPadProbeInfo *info, gpoint
     return GST_PAD_PROBE_OK;
 }
 
+// One-shot timer: the sink still has GIF frames to show when the decoder finishes a loop
+static int gif_loop_timer_fd = -1;
+
+// Restart the GIF with a flushing segment seek (see SEGMENT_DONE below)
+static void seek_gif_loop(void) {
+    if (!pipeline || shutting_down)
+        return;
+    gif_loop_start_us = g_get_monotonic_time();
+    if (!gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
+                               GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_SEGMENT, 0)) {
+        cflp_warning("GIF loop seek failed");
+    }
+}
+
+static void handle_gif_loop_timer(void) {
+    drain_loop_fd(gif_loop_timer_fd);
+    seek_gif_loop();
+}
+
 static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer data) {
     switch (GST_MESSAGE_TYPE(msg)) {
         case GST_MESSAGE_ERROR: {
@@ -1944,9 +3727,16 @@ static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer data) {
             
             g_error_free(err);
             g_free(debug_info);
+            // A decoder change that fails to preroll goes back to the previous decoder
+            if (decoder_replug_failed())
+                break;
             exit_slapper(EXIT_FAILURE);
             break;
         }
+        case GST_MESSAGE_ASYNC_DONE:
+            if (GST_MESSAGE_SRC(msg) == GST_OBJECT(pipeline))
+                decoder_replug_done();
+            break;
         case GST_MESSAGE_EOS:
             if (VERBOSE)
                 cflp_info("End of stream reached - fallback loop method");
@@ -1976,27 +3766,20 @@ static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer data) {
             // queued frames, so wait out the remaining display time before flushing or the loop runs fast.
             // Regular videos keep the gapless non-flush seek; avdemux_gif also never posts EOS with
             // playbin3, so EOS-based looping is not an option.
+            // CHANGED 2026-10-16 - Wait out the GIF display time on a timer - Problem: the wait slept
+            // inside the bus dispatcher, which now runs on the main loop
             if (pipeline && video_is_gif) {
                 gint64 duration = 0;
+                gint64 remaining_us = 0;
                 if (gst_element_query_duration(pipeline, GST_FORMAT_TIME, &duration) && duration > 0) {
-                    gint64 remaining_us = duration / 1000 - (g_get_monotonic_time() - gif_loop_start_us);
+                    remaining_us = duration / 1000 - (g_get_monotonic_time() - gif_loop_start_us);
                     if (remaining_us > 30 * G_USEC_PER_SEC)
                         remaining_us = 0;
-                    // Sleep in short chunks so shutdown is not held up and the
-                    // pipeline is never touched after exit_cleanup starts
-                    while (remaining_us > 0 && !shutting_down) {
-                        gint64 chunk = remaining_us < 50000 ? remaining_us : 50000;
-                        g_usleep(chunk);
-                        remaining_us -= chunk;
-                    }
-                }
-                if (shutting_down)
-                    break;
-                gif_loop_start_us = g_get_monotonic_time();
-                if (!gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
-                                           GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_SEGMENT, 0)) {
-                    cflp_warning("GIF loop seek failed");
                 }
+                if (remaining_us > 0 && gif_loop_timer_fd >= 0)
+                    arm_loop_timer(gif_loop_timer_fd, (remaining_us + 999) / 1000, 0);
+                else
+                    seek_gif_loop();
             } else if (pipeline && !shutting_down) {
                 if (!gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
                                            GST_SEEK_FLAG_SEGMENT, 0)) {
@@ -2022,8 +3805,8 @@ static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer data) {
                     
                     // CHANGED 2025-09-07 - Initialize segment-based looping when pipeline starts
                     // Problem: Need initial segment seek to enable SEGMENT_DONE messages instead of EOS
-                    static bool segment_initialized = false;
-                    if (!segment_initialized) {
+                    // Gapless looping never seeks; it needs the EOS that a segment seek suppresses
+                    if (!loop_segment_initialized && !gapless_loop) {
                         if (VERBOSE)
                             cflp_info("Setting up seamless segment-based looping");
                         gif_loop_start_us = g_get_monotonic_time();
@@ -2038,7 +3821,7 @@ static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer data) {
                             if (VERBOSE)
                                 cflp_success("Segment looping initialized successfully");
                         }
-                        segment_initialized = true;
+                        loop_segment_initialized = true;
                     }
                 }
             }
@@ -2050,34 +3833,48 @@ static gboolean bus_callback(GstBus *bus, GstMessage *msg, gpointer data) {
     return TRUE;
 }
 
-static void *handle_gst_events(void *_) {
-    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-    time_t start_time = time(NULL);
-
-    while (true) {
-        if (SLIDESHOW_TIME) {
-            if ((time(NULL) - start_time) >= SLIDESHOW_TIME) {
-                // For slideshow mode, we would need to implement playlist handling
-                // This is a placeholder
-                cflp_info("Slideshow next (not implemented)");
-                start_time = time(NULL);
-            }
+// Dispatch every queued bus message; the bus fd stays readable while any are queued
+static void dispatch_bus_messages(void) {
+    GstMessage *msg;
+    while (bus && (msg = gst_bus_pop(bus)) != NULL) {
+        // An image that fails to decode fails its change instead of exiting
+        if (image_load.active && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+            GError *error = NULL;
+            gchar *debug = NULL;
+            gst_message_parse_error(msg, &error, &debug);
+            cflp_error("Image decode error: %s", error->message);
+            g_error_free(error);
+            g_free(debug);
+            gst_message_unref(msg);
+            image_load_failed();  // Drops the pipeline and its bus
+            continue;
         }
-
-        // Handle GStreamer messages
-        if (bus) {
-            GstMessage *msg = gst_bus_timed_pop_filtered(bus, 10000, GST_MESSAGE_ANY);
-            
-            if (msg) {
-                bus_callback(bus, msg, NULL);
-                gst_message_unref(msg);
-            }
+        // Likewise a video change: the wallpaper it replaced comes back
+        if (video_switch.active && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+            GError *error = NULL;
+            gchar *debug = NULL;
+            gst_message_parse_error(msg, &error, &debug);
+            cflp_error("Video error: %s", error->message);
+            if (debug && VERBOSE)
+                cflp_error("Debug info: %s", debug);
+            g_error_free(error);
+            g_free(debug);
+            gst_message_unref(msg);
+            video_switch_failed();
+            continue;
         }
-
-        pthread_usleep(10000);
+        if (video_switch.active && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_STATE_CHANGED &&
+            GST_MESSAGE_SRC(msg) == GST_OBJECT(pipeline)) {
+            // Upward only: going to READY for the switch posts PLAYING -> PAUSED
+            GstState old_state, new_state;
+            gst_message_parse_state_changed(msg, &old_state, &new_state, NULL);
+            if (new_state == GST_STATE_PLAYING ||
+                (old_state == GST_STATE_READY && new_state == GST_STATE_PAUSED))
+                video_switch_done();
+        }
+        bus_callback(bus, msg, NULL);
+        gst_message_unref(msg);
     }
-
-    pthread_exit(NULL);
 }
 
 // IPC command execution (called from main loop)
@@ -2160,7 +3957,65 @@ static void execute_ipc_commands(void) {
             const char *state = (halt_info.is_paused > 0) ? "paused" : "playing";
             const char *mode = is_image_mode ? "image" : "video";
             const char *path = video_path ? video_path : "unknown";
-            snprintf(response, sizeof(response), "STATUS: %s %s %s\n", state, mode, path);
+            int len = snprintf(response, sizeof(response), "STATUS: %s %s %s\n", state, mode, path);
+            // CHANGED 2026-10-16 - Report the plugged decoder - Problem: no way to see whether playback fell back to software
+            pthread_mutex_lock(&decoder_mutex);
+            if (!is_image_mode && active_decoder[0] && len > 0 && (size_t)len < sizeof(response)) {
+                snprintf(response + len, sizeof(response) - len, "DECODER: %s %s %s\n", active_decoder,
+                         active_decoder_is_hw ? "hardware" : "software", decoder_policy_name(decoder_policy));
+            }
+            pthread_mutex_unlock(&decoder_mutex);
+            ipc_send_response(cmd->client_fd, response);
+        }
+        else if (strcmp(cmd_name, "set-decoder") == 0) {
+            int policy;
+            if (!arg || strlen(arg) == 0) {
+                ipc_send_response(cmd->client_fd, "ERROR: missing decoder mode argument\n");
+            } else if (!parse_decoder_policy(arg, &policy)) {
+                ipc_send_response(cmd->client_fd, "ERROR: unknown decoder mode (auto|hw|hw-only|sw)\n");
+            } else {
+                pthread_mutex_lock(&decoder_mutex);
+                bool busy = decoder_replug.active;
+                pthread_mutex_unlock(&decoder_mutex);
+                int previous = decoder_policy;
+                if (busy) {
+                    ipc_send_response(cmd->client_fd, "ERROR: decoder change in progress\n");
+                } else if (!apply_decoder_policy(policy)) {
+                    ipc_send_response(cmd->client_fd, "ERROR: no hardware video decoders installed\n");
+                } else if (pipeline && !is_image_mode) {
+                    // Answered by decoder_replug_done() or decoder_replug_failed()
+                    replug_video_decoder(previous, cmd->client_fd);
+                    cmd->client_fd = -1;
+                } else {
+                    char response[64];
+                    snprintf(response, sizeof(response), "OK: decoder mode %s\n", decoder_policy_name(policy));
+                    ipc_send_response(cmd->client_fd, response);
+                }
+            }
+        }
+        else if (strcmp(cmd_name, "set-fps") == 0) {
+            int fps;
+            if (!arg || strlen(arg) == 0) {
+                ipc_send_response(cmd->client_fd, "ERROR: missing frame rate argument\n");
+            } else if (!parse_frame_rate_cap(arg, &fps)) {
+                ipc_send_response(cmd->client_fd, "ERROR: invalid frame rate (1-1000 or auto)\n");
+            } else {
+                set_frame_rate_cap(fps);
+                ipc_send_response(cmd->client_fd, "OK\n");
+            }
+        }
+        else if (strcmp(cmd_name, "get-fps") == 0) {
+            char response[128];
+            pthread_mutex_lock(&frame_pacing.lock);
+            double effective = effective_frame_rate_locked();
+            double content = content_fps_num > 0 && content_fps_den > 0 ? (double)content_fps_num / content_fps_den : 0.0;
+            char cap[16];
+            if (frame_rate_cap == FRAME_RATE_AUTO)
+                snprintf(cap, sizeof(cap), "auto");
+            else
+                snprintf(cap, sizeof(cap), "%d", frame_rate_cap);
+            pthread_mutex_unlock(&frame_pacing.lock);
+            snprintf(response, sizeof(response), "FPS: cap=%s effective=%.2f content=%.2f\n", cap, effective, content);
             ipc_send_response(cmd->client_fd, response);
         }
         else if (strcmp(cmd_name, "change") == 0) {
@@ -2178,60 +4033,49 @@ static void execute_ipc_commands(void) {
                     // Check if we should use a transition for this change
                     bool use_transition = should_use_transition(arg);
                     
-                    if (use_transition && is_image_mode) {
-                        if (VERBOSE)
-                            cflp_info("IPC: Starting transition to %s", arg);
-                        
-                        // Start transition before changing wallpaper
-                        start_transition(arg);
-                        
-                        // Send response IMMEDIATELY so IPC doesn't block
-                        // Image loading will happen asynchronously
-                        ipc_send_response(cmd->client_fd, "OK: transition started\n");
-                        
-                        if (VERBOSE)
-                            cflp_info("IPC: Transition started, loading new image asynchronously...");
-                        
-                        // Reload image pipeline with new path (will update texture_manager.texture)
-                        // This may block briefly, but response is already sent
-                        if (!reload_image_pipeline(arg)) {
-                            // Transition was canceled due to error in reload_image_pipeline
-                            cflp_warning("IPC: Failed to load new image for transition");
-                            // Note: Can't send error response here as response already sent
-                            // Transition will be canceled automatically
-                        } else {
-                            if (VERBOSE)
-                                cflp_info("IPC: New image loaded, transition active=%d", transition_state.active);
-                        }
+                    if (is_static_image_path(arg)) {
+                        // Any wallpaper to image: the transition holds the old frame until the
+                        // new image arrives and keeps animating meanwhile
+                        if (use_transition)
+                            start_transition(arg);
+                        if (!is_image_mode)
+                            stop_video_pipeline();
                         
-                        if (VERBOSE)
-                            cflp_info("IPC: Change command completed");
-                    } else {
-                        // No transition - check if this is a static image (can reload directly)
-                        if (is_image_mode && is_static_image_path(arg)) {
-                            // For images, reload pipeline directly without restart
-                            if (reload_image_pipeline(arg)) {
-                                ipc_send_response(cmd->client_fd, "OK\n");
-                            } else {
-                                ipc_send_response(cmd->client_fd, "ERROR: failed to load image\n");
+                        if (transition_state.active) {
+                            // Send response IMMEDIATELY so IPC doesn't block
+                            // Image loading will happen asynchronously
+                            ipc_send_response(cmd->client_fd, "OK: transition started\n");
+                            if (!reload_image_pipeline(arg)) {
+                                // The transition was canceled; the response is already sent
+                                cflp_warning("IPC: Failed to load new image for transition");
+                            } else if (VERBOSE) {
+                                cflp_info("IPC: New image %s, transition active=%d",
+                                          image_load.active ? "decoding" : "loaded", transition_state.active);
                             }
-                        } else if (halt_info.argv_copy && halt_info.argc > 0) {
-                            // For videos or when auto-stop enabled, update path and restart
-                            free(halt_info.argv_copy[halt_info.argc - 1]);
-                            halt_info.argv_copy[halt_info.argc - 1] = strdup(arg);
-                            if (!halt_info.argv_copy[halt_info.argc - 1]) {
-                                ipc_send_response(cmd->client_fd, "ERROR: failed to allocate memory\n");
+                        } else if (reload_image_pipeline(arg)) {
+                            if (image_load.active) {
+                                // Answered by poll_image_load() once the image has decoded
+                                image_load.client_fd = cmd->client_fd;
+                                cmd->client_fd = -1;
                             } else {
-                                // Preserve IPC socket path in argv if set
-                                // (stop_slapper will restart with same args)
                                 ipc_send_response(cmd->client_fd, "OK\n");
-                                // Close write side to ensure response is flushed
-                                shutdown(cmd->client_fd, SHUT_WR);
-                                usleep(50000);  // Delay to ensure response is sent before restart
-                                stop_slapper();
                             }
                         } else {
-                            ipc_send_response(cmd->client_fd, "ERROR: cannot update path (use --auto-stop for video changes)\n");
+                            ipc_send_response(cmd->client_fd, "ERROR: failed to load image\n");
+                        }
+                    } else {
+                        // Any wallpaper to video: video to video reuses the running playbin,
+                        // image to video starts one; the current frame stays until the first new one
+                        if (use_transition)
+                            start_transition(arg);
+                        bool switched = !is_image_mode && pipeline ? switch_video(arg) : switch_to_video(arg);
+                        if (switched) {
+                            // Answered by video_switch_done() or video_switch_failed()
+                            video_switch.client_fd = cmd->client_fd;
+                            cmd->client_fd = -1;
+                        } else {
+                            cancel_transition();
+                            ipc_send_response(cmd->client_fd, "ERROR: failed to switch video\n");
                         }
                     }
                 }
@@ -2297,29 +4141,12 @@ static void execute_ipc_commands(void) {
                 ipc_send_response(cmd->client_fd, "OK: state saved\n");
             }
         }
-        else if (strcmp(cmd_name, "preload") == 0) {
-            if (!arg || strlen(arg) == 0) {
-                ipc_send_response(cmd->client_fd, "ERROR: missing path argument\n");
-            } else if (access(arg, R_OK) != 0) {
-                ipc_send_response(cmd->client_fd, "ERROR: file not accessible\n");
-            } else if (!is_image_file(arg)) {
-                ipc_send_response(cmd->client_fd, "ERROR: not an image file\n");
-            } else {
-                // TODO: Implement preload cache in Phase 2
-                ipc_send_response(cmd->client_fd, "OK: preload queued\n");
-            }
-        }
-        else if (strcmp(cmd_name, "unload") == 0) {
-            if (!arg || strlen(arg) == 0) {
-                ipc_send_response(cmd->client_fd, "ERROR: missing path argument\n");
-            } else {
-                // TODO: Implement preload cache in Phase 2
-                ipc_send_response(cmd->client_fd, "OK: unloaded\n");
-            }
-        }
+        // CHANGED 2026-10-16 - Drop the stub preload/unload/list branches - Problem: they shadowed the cache
+        // commands below, so unload answered OK without removing anything
         else if (strcmp(cmd_name, "list") == 0) {
-            // TODO: Implement preload cache listing in Phase 2
-            ipc_send_response(cmd->client_fd, "PRELOADED: (none)\n");
+            char response[8192];
+            preload_list(response, sizeof(response));
+            ipc_send_response(cmd->client_fd, response);
         }
         else if (strcmp(cmd_name, "set-transition") == 0) {
             if (!arg || strlen(arg) == 0) {
@@ -2369,38 +4196,90 @@ static void execute_ipc_commands(void) {
             cache_list(response, sizeof(response));
             ipc_send_response(cmd->client_fd, response);
         }
+        else if (strcmp(cmd_name, "stats") == 0) {
+            char response[512];
+            uint64_t rate_dropped = decode_rate_dropped();
+            pthread_mutex_lock(&render_stats.lock);
+            snprintf(response, sizeof(response),
+                     "STATS: uploads=%llu swaps=%llu skipped=%llu partial=%llu "
+                     "decoded=%llu dropped=%llu converted=%llu capped=%llu suspends=%llu resume_ms=%.1f "
+                     "loops=%llu loop_gap_ms=%.1f frame_ms=%.1f "
+                     "transition_ms=%.2f transition_max_ms=%.2f\n",
+                     (unsigned long long)render_stats.uploads,
+                     (unsigned long long)render_stats.swaps,
+                     (unsigned long long)render_stats.swaps_skipped,
+                     (unsigned long long)render_stats.partial_swaps,
+                     (unsigned long long)render_stats.decoded,
+                     (unsigned long long)rate_dropped,
+                     (unsigned long long)render_stats.converted,
+                     (unsigned long long)render_stats.capped,
+                     (unsigned long long)render_stats.suspends,
+                     render_stats.resume_ns / 1e6,
+                     (unsigned long long)render_stats.loops,
+                     render_stats.loop_gap_ns / 1e6,
+                     render_stats.frame_gap_ns / 1e6,
+                     render_stats.transition_frames ?
+                         render_stats.transition_total_ns / 1e6 / render_stats.transition_frames : 0.0,
+                     render_stats.transition_max_ns / 1e6);
+            pthread_mutex_unlock(&render_stats.lock);
+            ipc_send_response(cmd->client_fd, response);
+        }
         else if (strcmp(cmd_name, "cache-stats") == 0) {
             char response[256];
             cache_stats_str(response, sizeof(response));
             ipc_send_response(cmd->client_fd, response);
         }
         else if (strcmp(cmd_name, "unload") == 0) {
+            // Pending preloads are cancelled first so they cannot re-add what is removed
             if (!arg || strlen(arg) == 0) {
                 ipc_send_response(cmd->client_fd, "ERROR: missing argument (path, 'all', or 'unused')\n");
             } else if (strcmp(arg, "all") == 0) {
+                preload_cancel(NULL);
                 cache_clear();
                 ipc_send_response(cmd->client_fd, "OK: cache cleared\n");
             } else if (strcmp(arg, "unused") == 0) {
+                preload_cancel(NULL);
                 cache_clear_unused();
                 ipc_send_response(cmd->client_fd, "OK: unused entries cleared\n");
             } else {
-                cache_remove(arg);
+                // Cache keys are resolved paths
+                char resolved_path[PATH_MAX];
+                const char *key = realpath(arg, resolved_path) ? resolved_path : arg;
+                preload_cancel(key);
+                cache_remove(key);
                 ipc_send_response(cmd->client_fd, "OK: removed from cache\n");
             }
         }
         else if (strcmp(cmd_name, "preload") == 0) {
+            char resolved_path[PATH_MAX];
             if (!arg || strlen(arg) == 0) {
                 ipc_send_response(cmd->client_fd, "ERROR: missing path argument\n");
-            } else if (access(arg, R_OK) != 0) {
+            } else if (access(arg, R_OK) != 0 || realpath(arg, resolved_path) == NULL) {
                 ipc_send_response(cmd->client_fd, "ERROR: file not accessible\n");
             } else if (!is_image_file(arg)) {
                 ipc_send_response(cmd->client_fd, "ERROR: not a valid image file\n");
-            } else if (cache_contains(arg)) {
+            } else if (!is_static_image_path(arg)) {
+                ipc_send_response(cmd->client_fd, "ERROR: animated GIFs play as video and are not cached\n");
+            } else if (!cache_enabled()) {
+                ipc_send_response(cmd->client_fd, "ERROR: cache disabled\n");
+            } else if (cache_contains(resolved_path)) {
                 ipc_send_response(cmd->client_fd, "OK: already cached\n");
             } else {
-                // TODO: Full preload implementation requires separate decode pipeline
-                // For now, images are auto-cached when displayed via 'change' command
-                ipc_send_response(cmd->client_fd, "ERROR: preload not yet implemented, use 'change' to display and auto-cache\n");
+                // Decoded by the preload workers straight into the cache
+                switch (preload_submit(resolved_path)) {
+                case PRELOAD_QUEUED:
+                    ipc_send_response(cmd->client_fd, "OK: preload queued\n");
+                    break;
+                case PRELOAD_PENDING:
+                    ipc_send_response(cmd->client_fd, "OK: already queued\n");
+                    break;
+                case PRELOAD_QUEUE_FULL:
+                    ipc_send_response(cmd->client_fd, "ERROR: preload queue full\n");
+                    break;
+                default:
+                    ipc_send_response(cmd->client_fd, "ERROR: failed to queue preload\n");
+                    break;
+                }
             }
         }
         else if (strcmp(cmd_name, "listactive") == 0) {
@@ -2428,6 +4307,7 @@ static void execute_ipc_commands(void) {
                 "  pause                    Pause playback\n"
                 "  resume                   Resume playback\n"
                 "  query                    Get current status\n"
+                "  set-decoder <mode>       Set decoder choice (auto|hw|hw-only|sw)\n"
                 "  change <path>            Change wallpaper\n"
                 "  layer <name>             Set layer (background|bottom|top|overlay)\n"
                 "  stop, quit               Stop gslapper\n"
@@ -2436,10 +4316,14 @@ static void execute_ipc_commands(void) {
                 "  unload <path|all|unused> Remove from cache\n"
                 "  cache-list               List cached images\n"
                 "  cache-stats              Show cache statistics\n"
+                "  list                     List queued and running preloads\n"
                 "  set-transition <type>    Set transition (fade|none)\n"
                 "  get-transition           Get transition settings\n"
                 "  set-transition-duration <sec>  Set duration (0.0-5.0)\n"
+                "  set-fps <fps|auto>       Set frame rate cap (1-1000 or auto)\n"
+                "  get-fps                  Get frame rate cap and effective rate\n"
                 "  listactive               List active outputs\n"
+                "  stats                    Show frame upload/presentation counters\n"
                 "  help                     Show this help\n";
             ipc_send_response(cmd->client_fd, help_text);
         }
@@ -2455,99 +4339,441 @@ static void execute_ipc_commands(void) {
     }
 }
 
-static void init_threads() {
-    uint id = 0;
+// Slideshow tick (-n SECS)
+static int slideshow_timer_fd = -1;
 
-    pthread_create(&threads[id], NULL, handle_gst_events, NULL);
-    id++;
+static void handle_slideshow_timer(void) {
+    drain_loop_fd(slideshow_timer_fd);
+    // For slideshow mode, we would need to implement playlist handling
+    // This is a placeholder
+    cflp_info("Slideshow next (not implemented)");
+}
 
-    // Thread for monitoring if clappie is hidden
-    if (halt_info.auto_pause) {
-        pthread_create(&threads[id], NULL, handle_auto_pause, NULL);
-        id++;
-    } else if (halt_info.auto_stop) {
-        pthread_create(&threads[id], NULL, handle_auto_stop, NULL);
-        id++;
+// CHANGED 2026-10-16 - GStreamer bus dispatched from the main loop - Problem: the events thread
+// popped the bus with a 10 ms timeout and then slept another 10 ms, waking ~50 times a second
+// forever and delaying SEGMENT_DONE loop seeks by up to 20 ms. The main loop now polls the bus fd,
+// and the GIF loop delay and slideshow tick are timerfds. No helper threads remain.
+static void init_event_sources(void) {
+    // Auto-stop and the watch lists; auto-pause is handled by update_visibility()
+    init_auto_stop();
+    init_watch_lists();
+
+    if (video_is_gif)
+        gif_loop_timer_fd = create_loop_timer();
+    if (SLIDESHOW_TIME) {
+        slideshow_timer_fd = create_loop_timer();
+        if (slideshow_timer_fd >= 0)
+            arm_loop_timer(slideshow_timer_fd, SLIDESHOW_TIME * 1000, SLIDESHOW_TIME * 1000);
     }
+}
 
-    // Threads for monitoring watch lists
-    if (halt_info.pauselist) {
-        pthread_create(&threads[id], NULL, monitor_pauselist, NULL);
-        id++;
-    }
-    if (halt_info.stoplist) {
-        pthread_create(&threads[id], NULL, monitor_stoplist, NULL);
-        id++;
+// GStreamer option handling
+// Parse a --fps-cap / set-fps value: a whole number of frames per second or "auto"
+static bool parse_frame_rate_cap(const char *arg, int *fps) {
+    if (strcmp(arg, "auto") == 0) {
+        *fps = FRAME_RATE_AUTO;
+        return true;
     }
+    char *end;
+    long value = strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || value < 1 || value > FRAME_RATE_CAP_MAX)
+        return false;
+    *fps = (int)value;
+    return true;
+}
+
+// Frames per second actually let through, 0 if every frame is shown; frame_pacing.lock held
+static double effective_frame_rate_locked(void) {
+    if (frame_rate_cap != FRAME_RATE_AUTO)
+        return frame_rate_cap;
+    double fps = content_fps_num > 0 && content_fps_den > 0 ? (double)content_fps_num / content_fps_den : 0.0;
+    double refresh = fastest_refresh_mhz / 1000.0;
+    if (refresh > 0.0 && (fps == 0.0 || fps > refresh))
+        fps = refresh;
+    return fps;
+}
+
+static void update_frame_interval_locked(void) {
+    double fps = effective_frame_rate_locked();
+    target_frame_time_ns = fps > 0.0 ? (long long)(1e9 / fps) : 0;
+    next_frame_slot = GST_CLOCK_TIME_NONE;
+}
+
+// videorate max-rate: the fixed cap, or in auto mode the fastest refresh. The content
+// rate is left out so nothing upstream has to change when caps are renegotiated;
+// buffer_probe trims the fractional remainder.
+static void apply_frame_rate_filter(void) {
+    pthread_mutex_lock(&frame_pacing.lock);
+    int max_rate = frame_rate_cap != FRAME_RATE_AUTO ? frame_rate_cap :
+                   fastest_refresh_mhz > 0 ? (fastest_refresh_mhz + 999) / 1000 : G_MAXINT;
+    pthread_mutex_unlock(&frame_pacing.lock);
+
+    pthread_mutex_lock(&decode_filter.lock);
+    if (decode_filter.rate)
+        g_object_set(decode_filter.rate, "max-rate", max_rate, NULL);
+    pthread_mutex_unlock(&decode_filter.lock);
 }
 
-// GStreamer option handling
 static void set_frame_rate_cap(int fps) {
-    switch (fps) {
-        case 30:
-            target_frame_time_ns = 33333333; // 1/30 * 1e9
-            frame_rate_cap = 30;
-            break;
-        case 60:
-            target_frame_time_ns = 16666667; // 1/60 * 1e9
-            frame_rate_cap = 60;
-            break;
-        case 100:
-            target_frame_time_ns = 10000000; // 1/100 * 1e9
-            frame_rate_cap = 100;
-            break;
-        default:
-            cflp_warning("Invalid frame rate cap %d, using 30 FPS", fps);
-            target_frame_time_ns = 33333333;
-            frame_rate_cap = 30;
-            break;
+    pthread_mutex_lock(&frame_pacing.lock);
+    frame_rate_cap = fps;
+    update_frame_interval_locked();
+    double effective = effective_frame_rate_locked();
+    pthread_mutex_unlock(&frame_pacing.lock);
+    apply_frame_rate_filter();
+
+    if (VERBOSE) {
+        if (fps == FRAME_RATE_AUTO)
+            cflp_info("Frame rate cap set to auto (currently %s)", effective > 0.0 ? "content rate" : "unlimited");
+        else
+            cflp_info("Frame rate cap set to %d FPS", fps);
     }
-    
-    if (VERBOSE)
-        cflp_info("Frame rate cap set to %d FPS", frame_rate_cap);
 }
 
-static void apply_gst_options() {
-    if (VERBOSE)
-        cflp_info("Applying GStreamer options: %s", gst_options);
-    
-    // Parse gst_options and apply them to the pipeline
-    if (strstr(gst_options, "no-audio") != NULL || strstr(gst_options, "mute") != NULL) {
-        // Disable audio by setting flags
-        gint flags = 0x00000001; // GST_PLAY_FLAG_VIDEO only
-        g_object_set(G_OBJECT(pipeline), "flags", flags, NULL);
-    } else {
-        // Enable both video and audio
-        gint flags = 0x00000003; // GST_PLAY_FLAG_VIDEO | GST_PLAY_FLAG_AUDIO
-        g_object_set(G_OBJECT(pipeline), "flags", flags, NULL);
+// Content framerate from newly negotiated caps, for --fps-cap auto
+static void set_content_frame_rate(int num, int den) {
+    pthread_mutex_lock(&frame_pacing.lock);
+    bool changed = num != content_fps_num || den != content_fps_den;
+    content_fps_num = num;
+    content_fps_den = den;
+    if (changed)
+        update_frame_interval_locked();
+    double effective = effective_frame_rate_locked();
+    bool automatic = frame_rate_cap == FRAME_RATE_AUTO;
+    pthread_mutex_unlock(&frame_pacing.lock);
+
+    if (changed && automatic && VERBOSE)
+        cflp_info("Auto frame rate: content %.3f FPS, showing %.3f FPS",
+                  den > 0 ? (double)num / den : 0.0, effective);
+}
+
+// Clamp for --fps-cap auto: no output can show more than its current mode's refresh
+static void refresh_fastest_output_rate(struct wl_state *state) {
+    int fastest = 0;
+    struct display_output *output;
+    wl_list_for_each(output, &state->outputs, link) {
+        if (output->refresh_mhz > fastest)
+            fastest = output->refresh_mhz;
+    }
+    pthread_mutex_lock(&frame_pacing.lock);
+    bool changed = fastest != fastest_refresh_mhz;
+    if (changed) {
+        fastest_refresh_mhz = fastest;
+        update_frame_interval_locked();
+    }
+    pthread_mutex_unlock(&frame_pacing.lock);
+    if (changed)
+        apply_frame_rate_filter();
+}
+
+// Decimate the stream to the frame rate cap by running time, so skipped frames are
+// never uploaded. Slots advance by a fixed interval, which keeps the kept frames
+// evenly spaced when the cap does not divide the content rate.
+static bool frame_rate_admits(GstClockTime running_time) {
+    if (!GST_CLOCK_TIME_IS_VALID(running_time))
+        return true;
+
+    pthread_mutex_lock(&frame_pacing.lock);
+    bool admit = true;
+    GstClockTime interval = (GstClockTime)target_frame_time_ns;
+    if (interval > 0) {
+        const GstClockTime tolerance = GST_MSECOND;
+        // First frame, seek or loop back: start a new slot sequence here
+        if (!GST_CLOCK_TIME_IS_VALID(next_frame_slot) || running_time + 2 * interval < next_frame_slot) {
+            next_frame_slot = running_time + interval;
+        } else if (running_time + tolerance < next_frame_slot) {
+            admit = false;
+        } else {
+            next_frame_slot += interval;
+            if (next_frame_slot <= running_time)  // fell behind (stall), don't burst to catch up
+                next_frame_slot = running_time + interval;
+        }
     }
-    
-    // Handle loop options
-    if (strstr(gst_options, "loop") != NULL || SLIDESHOW_TIME != 0) {
-        // Loop is handled by seeking to beginning on EOS
-        if (VERBOSE)
-            cflp_info("Looping enabled");
+    pthread_mutex_unlock(&frame_pacing.lock);
+    return admit;
+}
+
+// CHANGED 2026-10-16 - Decoder selection by rank - Problem: playbin picked avdec_h264 on the CPU
+// even where a VA decoder existed; there was no way to prefer, require or forbid hardware decoding.
+
+static const char *decoder_policy_name(int policy) {
+    switch (policy) {
+        case DECODER_HW: return "hw";
+        case DECODER_HW_ONLY: return "hw-only";
+        case DECODER_SW: return "sw";
+        default: return "auto";
     }
+}
 
-    // Check for fill mode (fill screen maintaining aspect, crop excess)
-    if (strstr(gst_options, "fill") != NULL) {
-        fill_mode = true;
-        if (VERBOSE)
-            cflp_info("Fill mode enabled (crop to fill screen)");
+static bool parse_decoder_policy(const char *name, int *policy) {
+    if (strcmp(name, "auto") == 0)
+        *policy = DECODER_AUTO;
+    else if (strcmp(name, "hw") == 0)
+        *policy = DECODER_HW;
+    else if (strcmp(name, "hw-only") == 0)
+        *policy = DECODER_HW_ONLY;
+    else if (strcmp(name, "sw") == 0)
+        *policy = DECODER_SW;
+    else
+        return false;
+    return true;
+}
+
+// Hardware decoders declare "Hardware" in their klass; older VA-API,
+// V4L2 and vendor plugins are recognised by name.
+static bool is_hardware_decoder(GstElementFactory *factory) {
+    const gchar *klass = gst_element_factory_get_metadata(factory, GST_ELEMENT_METADATA_KLASS);
+    if (klass && strstr(klass, "Hardware"))
+        return true;
+
+    static const char *const prefixes[] = {
+        "va", "v4l2", "nv", "qsv", "msdk", "vulkan", "omx", NULL
+    };
+    const gchar *name = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory));
+    for (int i = 0; prefixes[i]; i++) {
+        if (g_str_has_prefix(name, prefixes[i]))
+            return true;
     }
+    return false;
+}
 
-    // Handle stretch option
-    if (strstr(gst_options, "stretch") != NULL) {
-        stretch_mode = true;
-        if (VERBOSE)
-            cflp_info("Stretch mode enabled");
+// Rank every video decoder for the policy. Installed ranks are remembered on
+// first use so "auto" can restore them. Returns false (ranks untouched) when
+// hw-only is requested but no hardware decoder is installed.
+static bool apply_decoder_policy(int policy) {
+    GList *decoders = gst_element_factory_list_get_elements(
+        GST_ELEMENT_FACTORY_TYPE_DECODER | GST_ELEMENT_FACTORY_TYPE_MEDIA_VIDEO, GST_RANK_NONE);
+
+    int hw_count = 0;
+    for (GList *l = decoders; l; l = l->next) {
+        if (is_hardware_decoder(GST_ELEMENT_FACTORY(l->data)))
+            hw_count++;
     }
-    
-    // Handle original resolution option
-    if (strstr(gst_options, "original") != NULL) {
-        panscan_value = -1.0f; // Special value to indicate original resolution mode
-        stretch_mode = false; // Original overrides stretch
-        if (VERBOSE)
+    if (policy == DECODER_HW_ONLY && hw_count == 0) {
+        gst_plugin_feature_list_free(decoders);
+        return false;
+    }
+
+    for (GList *l = decoders; l; l = l->next) {
+        GstPluginFeature *feature = GST_PLUGIN_FEATURE(l->data);
+        // Stored as rank + 1 so an installed rank of NONE is distinguishable
+        gpointer saved = g_object_get_data(G_OBJECT(feature), "gslapper-installed-rank");
+        if (!saved) {
+            saved = GUINT_TO_POINTER(gst_plugin_feature_get_rank(feature) + 1);
+            g_object_set_data(G_OBJECT(feature), "gslapper-installed-rank", saved);
+        }
+        guint rank = GPOINTER_TO_UINT(saved) - 1;
+        bool hw = is_hardware_decoder(GST_ELEMENT_FACTORY(feature));
+
+        switch (policy) {
+            case DECODER_HW:
+            case DECODER_HW_ONLY:
+                if (hw)
+                    rank = MAX(rank, GST_RANK_PRIMARY + 1);
+                else if (policy == DECODER_HW_ONLY)
+                    rank = GST_RANK_NONE;
+                break;
+            case DECODER_SW:
+                if (hw)
+                    rank = GST_RANK_NONE;
+                break;
+            default:
+                break;
+        }
+        gst_plugin_feature_set_rank(feature, rank);
+    }
+    gst_plugin_feature_list_free(decoders);
+
+    decoder_policy = policy;
+    if (VERBOSE)
+        cflp_info("Decoder policy %s (%d hardware video decoders installed)",
+                  decoder_policy_name(policy), hw_count);
+    return true;
+}
+
+// CHANGED 2026-10-16 - Optional gapless loop on a second decoder - Problem: segment seeks stutter
+// for GIFs and demuxers that need flushing seeks, dropping or repeating frames at the loop point.
+// playbin "about-to-finish" (streaming thread) fires once the current file has been read to the
+// end; queueing the same URI makes playbin preroll it on a second decoder while the first drains
+// and switch the sink's input at the boundary. No seek or flush, and running time keeps counting,
+// so frame pacing carries straight across the loop.
+static void on_about_to_finish(GstElement *playbin, gpointer user_data) {
+    (void)user_data;
+    if (shutting_down)
+        return;
+    gchar *uri = NULL;
+    g_object_get(G_OBJECT(playbin), "current-uri", &uri, NULL);
+    if (uri) {
+        g_object_set(G_OBJECT(playbin), "uri", uri, NULL);
+        g_free(uri);
+    }
+}
+
+// playbin "element-setup": record which video decoder was plugged
+static void on_element_setup(GstElement *playbin, GstElement *element, gpointer user_data) {
+    (void)playbin;
+    (void)user_data;
+    GstElementFactory *factory = gst_element_get_factory(element);
+    if (!factory || !gst_element_factory_list_is_type(factory,
+            GST_ELEMENT_FACTORY_TYPE_DECODER | GST_ELEMENT_FACTORY_TYPE_MEDIA_VIDEO))
+        return;
+
+    const gchar *name = gst_plugin_feature_get_name(GST_PLUGIN_FEATURE(factory));
+    bool hw = is_hardware_decoder(factory);
+    pthread_mutex_lock(&decoder_mutex);
+    g_strlcpy(active_decoder, name, sizeof(active_decoder));
+    active_decoder_is_hw = hw;
+    pthread_mutex_unlock(&decoder_mutex);
+
+    if (VERBOSE)
+        cflp_info("Video decoder: %s (%s)", name, hw ? "hardware" : "software");
+    if (decoder_policy == DECODER_HW && !hw)
+        cflp_warning("No hardware decoder for this stream, using software decoder %s", name);
+}
+
+// Go through READY, which drops the decodebin so the new ranks apply, and
+// start again. False if the pipeline refused to start.
+static bool restart_for_decoder(void) {
+    gst_element_set_state(pipeline, GST_STATE_READY);
+    GstState target = halt_info.is_paused > 0 ? GST_STATE_PAUSED : GST_STATE_PLAYING;
+    GstStateChangeReturn ret = gst_element_set_state(pipeline, target);
+    if (ret == GST_STATE_CHANGE_FAILURE)
+        return false;
+    if (ret != GST_STATE_CHANGE_ASYNC)
+        decoder_replug_done();  // Nothing to preroll, so no ASYNC_DONE follows
+    return true;
+}
+
+// Re-run autoplugging after a policy change, resuming at the same position.
+// The main loop carries on; client_fd is answered once the pipeline has
+// prerolled with the new decoder, or has gone back to previous_policy.
+static void replug_video_decoder(int previous_policy, int client_fd) {
+    gint64 position = 0;
+    if (!gst_element_query_position(pipeline, GST_FORMAT_TIME, &position))
+        position = -1;
+
+    pthread_mutex_lock(&decoder_mutex);
+    decoder_replug.active = true;
+    decoder_replug.restoring = false;
+    decoder_replug.client_fd = client_fd;
+    decoder_replug.previous_policy = previous_policy;
+    decoder_replug.position = position;
+    pthread_mutex_unlock(&decoder_mutex);
+
+    if (!restart_for_decoder())
+        decoder_replug_failed();
+}
+
+// Send the result to the IPC client waiting on set-decoder, if any
+static void answer_decoder_replug(int client_fd, const char *response) {
+    if (client_fd < 0)
+        return;
+    ipc_send_response(client_fd, response);
+    close(client_fd);
+}
+
+// The pipeline prerolled: resume at the old position and report the policy in use
+static void decoder_replug_done(void) {
+    pthread_mutex_lock(&decoder_mutex);
+    if (!decoder_replug.active) {
+        pthread_mutex_unlock(&decoder_mutex);
+        return;
+    }
+    decoder_replug.active = false;
+    decoder_replug.restoring = false;
+    gint64 position = decoder_replug.position;
+    int client_fd = decoder_replug.client_fd;
+    decoder_replug.client_fd = -1;
+    pthread_mutex_unlock(&decoder_mutex);
+
+    if (position >= 0)
+        gst_element_seek_simple(pipeline, GST_FORMAT_TIME,
+                                GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT, position);
+    char response[64];
+    snprintf(response, sizeof(response), "OK: decoder mode %s\n", decoder_policy_name(decoder_policy));
+    answer_decoder_replug(client_fd, response);
+}
+
+// The pipeline failed to preroll with the new ranks: fail the request, put the
+// previous policy back and replug once more. Returns false when there was
+// nothing to undo (no change pending, or the previous policy failed as well).
+static bool decoder_replug_failed(void) {
+    pthread_mutex_lock(&decoder_mutex);
+    if (!decoder_replug.active || decoder_replug.restoring) {
+        decoder_replug.active = false;
+        decoder_replug.restoring = false;
+        pthread_mutex_unlock(&decoder_mutex);
+        return false;
+    }
+    decoder_replug.restoring = true;
+    int previous = decoder_replug.previous_policy;
+    int client_fd = decoder_replug.client_fd;
+    decoder_replug.client_fd = -1;
+    pthread_mutex_unlock(&decoder_mutex);
+
+    answer_decoder_replug(client_fd, "ERROR: failed to restart pipeline with new decoder\n");
+    cflp_warning("Decoder mode %s failed to start, going back to %s",
+                 decoder_policy_name(decoder_policy), decoder_policy_name(previous));
+    apply_decoder_policy(previous);  // Applied before, so its decoders exist
+    if (!restart_for_decoder()) {
+        cflp_error("Failed to restart pipeline with decoder mode %s", decoder_policy_name(previous));
+        pthread_mutex_lock(&decoder_mutex);
+        decoder_replug.active = false;
+        decoder_replug.restoring = false;
+        pthread_mutex_unlock(&decoder_mutex);
+    }
+    return true;
+}
+
+static void apply_gst_options() {
+    if (VERBOSE)
+        cflp_info("Applying GStreamer options: %s", gst_options);
+    
+    // Parse gst_options and apply them to the pipeline
+    gint flags;
+    if (strstr(gst_options, "no-audio") != NULL || strstr(gst_options, "mute") != NULL) {
+        // Disable audio by setting flags
+        flags = 0x00000001; // GST_PLAY_FLAG_VIDEO only
+    } else {
+        // Enable both video and audio
+        flags = 0x00000003; // GST_PLAY_FLAG_VIDEO | GST_PLAY_FLAG_AUDIO
+    }
+    // CHANGED 2026-10-16 - Keep playsink's converters out of the DMA-BUF path - Problem: its videoconvert only handles system memory and forced every frame through a CPU copy
+    if (dmabuf_upload_active() || gl_upload_active())
+        flags |= 0x00000040; // GST_PLAY_FLAG_NATIVE_VIDEO
+    g_object_set(G_OBJECT(pipeline), "flags", flags, NULL);
+    
+    // Handle loop options
+    if (strstr(gst_options, "loop=gapless") != NULL) {
+        // Loop by queueing the file again before it ends (on_about_to_finish)
+        gapless_loop = true;
+        if (VERBOSE)
+            cflp_info("Gapless looping enabled (second decoder)");
+    } else if (strstr(gst_options, "loop") != NULL || SLIDESHOW_TIME != 0) {
+        // Loop is handled by seeking to beginning on EOS
+        if (VERBOSE)
+            cflp_info("Looping enabled");
+    }
+
+    // Check for fill mode (fill screen maintaining aspect, crop excess)
+    if (strstr(gst_options, "fill") != NULL) {
+        fill_mode = true;
+        if (VERBOSE)
+            cflp_info("Fill mode enabled (crop to fill screen)");
+    }
+
+    // Handle stretch option
+    if (strstr(gst_options, "stretch") != NULL) {
+        stretch_mode = true;
+        if (VERBOSE)
+            cflp_info("Stretch mode enabled");
+    }
+    
+    // Handle original resolution option
+    if (strstr(gst_options, "original") != NULL) {
+        panscan_value = -1.0f; // Special value to indicate original resolution mode
+        stretch_mode = false; // Original overrides stretch
+        if (VERBOSE)
             cflp_info("Original resolution mode enabled");
     }
     
@@ -2691,13 +4917,307 @@ static void on_decodebin_pad_added(GstElement *decodebin, GstPad *pad, gpointer
     gst_object_unref(sink_pad);
 }
 
+// Show a cached image without copying it: the frame takes over the cache_get()
+// reference and borrows the entry's pixels until it has been uploaded
+static void show_cached_image(cache_entry_t *cached) {
+    pthread_mutex_lock(&video_mutex);
+    release_video_frame_locked();
+    video_frame_data.cache_entry = cached;
+    video_frame_data.data = (gpointer)cached->data;
+    video_frame_data.size = cached->size;
+    video_frame_data.width = cached->width;
+    video_frame_data.height = cached->height;
+    video_frame_data.compressed_format = cached->format == CACHE_FORMAT_GPU ? cached->gl_format : 0;
+    video_frame_data.has_new_frame = TRUE;
+    image_frame_captured = true;
+    pthread_mutex_unlock(&video_mutex);
+}
+
+// A decoded image frame shared with the cache; released with the entry's last reference
+typedef struct {
+    GstBuffer *buffer;
+    GstMapInfo map;
+} cached_frame_t;
+
+static void release_cached_frame(void *owner) {
+    cached_frame_t *frame = owner;
+    gst_buffer_unmap(frame->buffer, &frame->map);
+    gst_buffer_unref(frame->buffer);
+    free(frame);
+}
+
+// Keep the captured image frame's buffer for the cache instead of copying it.
+// Returns NULL when caching is off or the frame isn't tightly packed RGBA in
+// system memory (the cache layout). Caller must hold video_mutex.
+static cached_frame_t *retain_image_frame_locked(void) {
+    if ((!cache_enabled() && !diskcache_enabled()) || !video_frame_data.buffer || !video_frame_data.data ||
+        video_frame_data.is_dmabuf || video_frame_data.is_glmemory ||
+        video_frame_data.format != FRAME_FORMAT_RGBA)
+        return NULL;
+
+    gsize row = (gsize)video_frame_data.width * 4;
+    gint stride = video_frame_data.plane_stride[0];
+    if (video_frame_data.plane_offset[0] != 0 || (stride != 0 && (gsize)stride != row) ||
+        video_frame_data.size < row * video_frame_data.height)
+        return NULL;
+
+    cached_frame_t *frame = calloc(1, sizeof(cached_frame_t));
+    if (!frame)
+        return NULL;
+    frame->buffer = gst_buffer_ref(video_frame_data.buffer);
+    if (!gst_buffer_map(frame->buffer, &frame->map, GST_MAP_READ)) {
+        gst_buffer_unref(frame->buffer);
+        free(frame);
+        return NULL;
+    }
+    return frame;
+}
+
+// Encode RGBA pixels into format by letting the driver compress them on
+// upload and reading the blocks back. Returns malloc'd blocks, NULL if the
+// driver fails. Runs on the GPU encoder's context.
+static unsigned char *transcode_for_cache(const unsigned char *rgba, int width, int height,
+                                          GLenum format, size_t *size) {
+    while (glGetError() != GL_NO_ERROR); // clear stale errors
+    GLuint texture;
+    glGenTextures(1, &texture);
+    init_plane_texture(texture);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+
+    GLint compressed = GL_FALSE, internal = 0, compressed_size = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &compressed);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &compressed_size);
+
+    unsigned char *blocks = NULL;
+    if (glGetError() == GL_NO_ERROR && compressed == GL_TRUE &&
+        (GLenum)internal == format && compressed_size > 0) {
+        blocks = malloc((size_t)compressed_size);
+        if (blocks) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glGetCompressedTexImage(GL_TEXTURE_2D, 0, blocks);
+            if (glGetError() != GL_NO_ERROR) {
+                free(blocks);
+                blocks = NULL;
+            }
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDeleteTextures(1, &texture);
+
+    if (blocks)
+        *size = (size_t)compressed_size;
+    return blocks;
+}
+
+// Cached images waiting for the GPU encoder; more are left to zstd
+#define GPU_ENCODE_QUEUE_MAX 4
+
+typedef struct gpu_encode_job {
+    cache_entry_t *entry;              // Cached RGBA entry to replace
+    struct gpu_encode_job *next;
+} gpu_encode_job_t;
+
+// CHANGED 2026-10-16 - Encode on a worker with a shared context - Problem: the driver's BPTC/DXT1 encode
+// took hundreds of ms for a 4K image and stalled the main loop (Wayland, IPC, transitions) meanwhile
+// Transcodes cached RGBA entries to cache_gpu_format on its own context, shared
+// with egl_context, and swaps the blocks into the cache. Started on first use.
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;               // job queued or stop requested
+    gpu_encode_job_t *head, *tail;
+    int queued;
+    pthread_t thread;
+    EGLContext context;
+    bool running;
+    bool stopping;
+} gpu_encoder = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void *gpu_encoder_main(void *data) {
+    (void)data;
+    if (!eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, gpu_encoder.context)) {
+        cflp_warning("Failed to make the cache encoder context current, caching without GPU formats");
+        pthread_mutex_lock(&gpu_encoder.lock);
+        cache_gpu_format = 0;
+        pthread_mutex_unlock(&gpu_encoder.lock);
+    }
+
+    pthread_mutex_lock(&gpu_encoder.lock);
+    while (!gpu_encoder.stopping) {
+        if (!gpu_encoder.head) {
+            pthread_cond_wait(&gpu_encoder.cond, &gpu_encoder.lock);
+            continue;
+        }
+
+        gpu_encode_job_t *job = gpu_encoder.head;
+        gpu_encoder.head = job->next;
+        if (!gpu_encoder.head)
+            gpu_encoder.tail = NULL;
+        gpu_encoder.queued--;
+        GLenum format = cache_gpu_format;
+        pthread_mutex_unlock(&gpu_encoder.lock);
+
+        cache_entry_t *rgba = job->entry;
+        free(job);
+        size_t size = 0;
+        unsigned char *blocks = format ?
+            transcode_for_cache(rgba->data, rgba->width, rgba->height, format, &size) : NULL;
+        if (blocks) {
+            cache_entry_t *packed = cache_entry_wrap_encoded(blocks, size, rgba->width, rgba->height,
+                                                             CACHE_FORMAT_GPU, format);
+            cache_replace(rgba, packed);
+            cache_entry_unref(packed);
+        } else {
+            if (format) {
+                cflp_warning("Driver failed to compress a %dx%d image to format 0x%x, caching without it",
+                             rgba->width, rgba->height, format);
+                pthread_mutex_lock(&gpu_encoder.lock);
+                cache_gpu_format = 0;
+                pthread_mutex_unlock(&gpu_encoder.lock);
+            }
+            preload_pack(rgba);
+        }
+        cache_entry_unref(rgba);
+
+        pthread_mutex_lock(&gpu_encoder.lock);
+    }
+    pthread_mutex_unlock(&gpu_encoder.lock);
+
+    eglMakeCurrent(egl_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglReleaseThread();
+    return NULL;
+}
+
+// Queue a cached RGBA entry for the GPU encoder. Returns false when no GPU
+// format is in use or the queue is full. Main thread only.
+static bool queue_gpu_encode(cache_entry_t *entry) {
+    pthread_mutex_lock(&gpu_encoder.lock);
+    if (!cache_gpu_format || gpu_encoder.stopping || gpu_encoder.queued >= GPU_ENCODE_QUEUE_MAX) {
+        pthread_mutex_unlock(&gpu_encoder.lock);
+        return false;
+    }
+    if (!gpu_encoder.running) {
+        gpu_encoder.context = eglCreateContext(egl_display, egl_config, egl_context,
+                                               render_threads.context_attrib);
+        gpu_encoder.running = gpu_encoder.context != EGL_NO_CONTEXT &&
+            pthread_create(&gpu_encoder.thread, NULL, gpu_encoder_main, NULL) == 0;
+        if (!gpu_encoder.running) {
+            if (gpu_encoder.context != EGL_NO_CONTEXT)
+                eglDestroyContext(egl_display, gpu_encoder.context);
+            gpu_encoder.context = EGL_NO_CONTEXT;
+            cache_gpu_format = 0;
+            pthread_mutex_unlock(&gpu_encoder.lock);
+            cflp_warning("Failed to start the cache encoder thread, caching without GPU formats");
+            return false;
+        }
+    }
+    gpu_encode_job_t *job = calloc(1, sizeof(*job));
+    if (!job) {
+        pthread_mutex_unlock(&gpu_encoder.lock);
+        return false;
+    }
+    job->entry = cache_entry_ref(entry);
+    if (gpu_encoder.tail)
+        gpu_encoder.tail->next = job;
+    else
+        gpu_encoder.head = job;
+    gpu_encoder.tail = job;
+    gpu_encoder.queued++;
+    pthread_cond_signal(&gpu_encoder.cond);
+    pthread_mutex_unlock(&gpu_encoder.lock);
+    return true;
+}
+
+// Drop queued encodes, finish the running one and destroy the context
+static void stop_gpu_encoder(void) {
+    pthread_mutex_lock(&gpu_encoder.lock);
+    gpu_encoder.stopping = true;
+    gpu_encode_job_t *dropped = gpu_encoder.head;
+    gpu_encoder.head = gpu_encoder.tail = NULL;
+    gpu_encoder.queued = 0;
+    pthread_cond_broadcast(&gpu_encoder.cond);
+    bool running = gpu_encoder.running;
+    pthread_mutex_unlock(&gpu_encoder.lock);
+
+    while (dropped) {
+        gpu_encode_job_t *next = dropped->next;
+        cache_entry_unref(dropped->entry);
+        free(dropped);
+        dropped = next;
+    }
+    if (running) {
+        pthread_join(gpu_encoder.thread, NULL);
+        eglDestroyContext(egl_display, gpu_encoder.context);
+        gpu_encoder.context = EGL_NO_CONTEXT;
+        gpu_encoder.running = false;
+    }
+}
+
+// Add a retained frame to the cache, displayed in place of old_path (may be
+// empty), and write it to the disk tier
+// CHANGED 2026-10-16 - Compress off the main thread - Problem: encoding a 4K image here stalled the main
+// loop; the RGBA entry is cached at once and swapped for the packed one when a worker finishes
+static void cache_image_frame(cached_frame_t *frame, const char *path, const char *old_path,
+                              int width, int height) {
+    if (!frame)
+        return;
+    if (old_path[0] != '\0')
+        cache_set_displayed(old_path, false);
+
+    // The disk tier keeps RGBA, so it shares the decoded frame either way
+    cache_entry_t *rgba = cache_entry_wrap(frame->map.data, width, height, release_cached_frame, frame);
+    if (!rgba)
+        return;
+    diskcache_store(path, rgba);
+
+    if (cache_enabled()) {
+        cache_entry_t *entry = cache_insert(path, rgba);
+        cache_set_displayed(path, true);
+        // --cache-compress: GPU format on the encoder thread, zstd on a preload worker
+        if (entry && entry->format == CACHE_FORMAT_RGBA && cache_compression() != CACHE_COMPRESS_OFF &&
+            !queue_gpu_encode(entry))
+            preload_pack(entry);
+        cache_entry_unref(entry);
+    }
+    cache_entry_unref(rgba);
+}
+
+// Look an image up in the memory cache, then the disk tier. zstd entries are
+// decompressed into a private RGBA copy. Returns a reference, NULL on a miss.
+static cache_entry_t *find_cached_image(const char *path) {
+    cache_entry_t *cached = cache_get(path);
+    if (!cached)
+        cached = diskcache_load(path);
+    if (cached && cached->format == CACHE_FORMAT_ZSTD) {
+        cache_entry_t *rgba = cache_entry_decode(cached);
+        cache_entry_unref(cached);
+        if (!rgba)
+            cache_remove(path);
+        cached = rgba;
+    }
+    return cached;
+}
+
 // Image pipeline initialization (for static images)
 // Reload image pipeline with new path (for transitions)
-// Returns true on success, false on failure
+// Returns true when the image is shown (cache hit) or decoding has started
+// (image_load.active, finished by poll_image_load()), false on failure
 static bool reload_image_pipeline(const char *new_path) {
     if (VERBOSE)
         cflp_info("Reloading image pipeline for: %s", new_path);
 
+    // A change still decoding is replaced by this one
+    if (image_load.active) {
+        image_load.active = false;
+        if (image_load.timer_fd >= 0)
+            arm_loop_timer(image_load.timer_fd, 0, 0);
+        answer_image_load("ERROR: superseded by another change\n");
+    }
+
     // Track old path for cache display status update
     char old_resolved_path[PATH_MAX] = {0};
     if (video_path) {
@@ -2708,7 +5228,6 @@ static bool reload_image_pipeline(const char *new_path) {
     if (pipeline) {
         gst_element_set_state(pipeline, GST_STATE_NULL);
         if (bus) {
-            gst_bus_remove_watch(bus);
             gst_object_unref(bus);
             bus = NULL;
         }
@@ -2740,6 +5259,8 @@ static bool reload_image_pipeline(const char *new_path) {
 
     // Update is_image_mode
     is_image_mode = is_static_image_path(new_path);
+    apply_image_fill_default(is_image_mode);
+    remember_restart_path(new_path);
 
     // Build the new image pipeline inline (don't call init_image_pipeline to avoid exit on error)
     char resolved_path[PATH_MAX];
@@ -2750,19 +5271,13 @@ static bool reload_image_pipeline(const char *new_path) {
     }
 
     // Check cache first
-    cache_entry_t *cached = cache_get(resolved_path);
+    // CHANGED 2026-10-16 - Fall back to the disk tier - Problem: every login decoded the startup image again
+    cache_entry_t *cached = find_cached_image(resolved_path);
     if (cached) {
         // Cache hit - use cached data directly
-        pthread_mutex_lock(&video_mutex);
-        // CHANGED 2026-07-08 - Ownership-aware release before installing heap-owned cache copy - Problem: previous frame may be a mapped GstBuffer
-        release_video_frame_locked();
-        video_frame_data.data = g_memdup2(cached->data, cached->size);
-        video_frame_data.size = cached->size;
-        video_frame_data.width = cached->width;
-        video_frame_data.height = cached->height;
-        video_frame_data.has_new_frame = TRUE;
-        image_frame_captured = true;
-        pthread_mutex_unlock(&video_mutex);
+        // CHANGED 2026-10-16 - Borrow the entry instead of g_memdup2 - Problem: each hit copied the whole image
+        int width = cached->width, height = cached->height;
+        show_cached_image(cached);
 
         // Update display status
         if (old_resolved_path[0] != '\0') {
@@ -2771,7 +5286,7 @@ static bool reload_image_pipeline(const char *new_path) {
         cache_set_displayed(resolved_path, true);
 
         if (VERBOSE)
-            cflp_success("New image loaded from cache: %dx%d", cached->width, cached->height);
+            cflp_success("New image loaded from cache: %dx%d", width, height);
         return true;
     }
 
@@ -2875,79 +5390,85 @@ static bool reload_image_pipeline(const char *new_path) {
         return false;
     }
 
-    // Wait for the frame to be captured (with timeout)
-    // Process events during wait to keep IPC responsive
-    int timeout_ms = 5000;
-    int waited = 0;
-    while (!image_frame_captured && waited < timeout_ms) {
-        // Process GStreamer bus messages (non-blocking)
-        GstMessage *msg = gst_bus_pop(bus);
-        if (msg) {
-            if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
-                GError *error = NULL;
-                gchar *debug = NULL;
-                gst_message_parse_error(msg, &error, &debug);
-                cflp_error("Image decode error: %s", error->message);
-                g_error_free(error);
-                g_free(debug);
-                gst_message_unref(msg);
-                gst_object_unref(bus);
-                bus = NULL;
-                gst_object_unref(pipeline);
-                pipeline = NULL;
-                cancel_transition();
-                return false;
-            }
-            gst_message_unref(msg);
-        }
-        
-        // Process Wayland events if available (non-blocking)
-        // This keeps IPC responsive during image loading
-        if (global_state && global_state->display) {
-            // Try to dispatch pending events without blocking
-            wl_display_dispatch_pending(global_state->display);
-            // Flush to send any pending requests
-            wl_display_flush(global_state->display);
-        }
-        
-        // Handle shutdown signals arriving during the decode wait
-        process_pending_signal();
+    // The frame arrives on the streaming thread; poll_image_load() finishes
+    // the change from the main loop, which keeps running meanwhile
+    if (image_load.timer_fd < 0)
+        image_load.timer_fd = create_loop_timer();
+    if (image_load.timer_fd >= 0)
+        arm_loop_timer(image_load.timer_fd, IMAGE_LOAD_TIMEOUT_MS, 0);
+    snprintf(image_load.resolved_path, sizeof(image_load.resolved_path), "%s", resolved_path);
+    snprintf(image_load.old_resolved_path, sizeof(image_load.old_resolved_path), "%s", old_resolved_path);
+    image_load.active = true;
+    return true;
+}
 
-        // Short sleep to avoid busy-waiting
-        g_usleep(10000);  // 10ms - balance between responsiveness and CPU usage
-        waited += 10;  // Increment by sleep duration
-    }
+// Send the result to the IPC client waiting on the image change, if any
+static void answer_image_load(const char *response) {
+    if (image_load.client_fd < 0)
+        return;
+    ipc_send_response(image_load.client_fd, response);
+    close(image_load.client_fd);
+    image_load.client_fd = -1;
+}
 
-    if (!image_frame_captured) {
-        cflp_error("Timeout waiting for image frame");
-        gst_object_unref(bus);
-        bus = NULL;
-        gst_object_unref(pipeline);
-        pipeline = NULL;
-        cancel_transition();
-        return false;
-    }
+// Finish the pending image change once its frame has been captured. Called
+// before the frame is uploaded, so its buffer can still be kept for the cache.
+static void poll_image_load(void) {
+    if (!image_load.active)
+        return;
 
-    // Stop pipeline (we have the frame in texture)
+    pthread_mutex_lock(&video_mutex);
+    bool captured = image_frame_captured;
+    int width = video_frame_data.width;
+    int height = video_frame_data.height;
+    cached_frame_t *cache_frame = captured ? retain_image_frame_locked() : NULL;
+    pthread_mutex_unlock(&video_mutex);
+    if (!captured)
+        return;
+
+    image_load.active = false;
+    if (image_load.timer_fd >= 0)
+        arm_loop_timer(image_load.timer_fd, 0, 0);
+
+    // Stop pipeline (we have the frame); video_mutex must not be held here,
+    // the streaming thread may still be waiting for it
     gst_element_set_state(pipeline, GST_STATE_NULL);
 
     // Add to cache for instant loading next time
-    if (cache_enabled() && video_frame_data.data) {
-        unsigned char *cache_copy = g_memdup2(video_frame_data.data, video_frame_data.size);
-        if (cache_copy) {
-            // Update display status
-            if (old_resolved_path[0] != '\0') {
-                cache_set_displayed(old_resolved_path, false);
-            }
-            cache_add(resolved_path, cache_copy, video_frame_data.width, video_frame_data.height);
-            cache_set_displayed(resolved_path, true);
-        }
-    }
+    cache_image_frame(cache_frame, image_load.resolved_path, image_load.old_resolved_path, width, height);
 
     if (VERBOSE)
-        cflp_success("New image loaded: %dx%d", video_frame_data.width, video_frame_data.height);
+        cflp_success("New image loaded: %dx%d", width, height);
+    answer_image_load("OK\n");
+}
 
-    return true;
+// The pending image change failed (decode error or timeout): drop its pipeline
+static void image_load_failed(void) {
+    if (!image_load.active)
+        return;
+    image_load.active = false;
+    if (image_load.timer_fd >= 0)
+        arm_loop_timer(image_load.timer_fd, 0, 0);
+
+    if (bus) {
+        gst_object_unref(bus);
+        bus = NULL;
+    }
+    if (pipeline) {
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(pipeline);
+        pipeline = NULL;
+    }
+    cancel_transition();
+    answer_image_load("ERROR: failed to load image\n");
+}
+
+static void handle_image_load_timer(void) {
+    drain_loop_fd(image_load.timer_fd);
+    if (!image_load.active)
+        return;
+    cflp_error("Timeout waiting for image frame");
+    image_load_failed();
 }
 
 static void init_image_pipeline(void) {
@@ -2958,24 +5479,17 @@ static void init_image_pipeline(void) {
         exit_slapper(EXIT_FAILURE);
     }
 
-    cache_entry_t *cached = cache_get(resolved_path);
+    // CHANGED 2026-10-16 - Fall back to the disk tier - Problem: every login decoded the startup image again
+    cache_entry_t *cached = find_cached_image(resolved_path);
     if (cached) {
         // Cache hit - use cached data directly
-        pthread_mutex_lock(&video_mutex);
-        // CHANGED 2026-07-08 - Ownership-aware release before installing heap-owned cache copy - Problem: previous frame may be a mapped GstBuffer
-        release_video_frame_locked();
-        video_frame_data.data = g_memdup2(cached->data, cached->size);
-        video_frame_data.size = cached->size;
-        video_frame_data.width = cached->width;
-        video_frame_data.height = cached->height;
-        video_frame_data.has_new_frame = TRUE;
-        image_frame_captured = true;
-        pthread_mutex_unlock(&video_mutex);
+        int width = cached->width, height = cached->height;
+        show_cached_image(cached);
 
         cache_set_displayed(resolved_path, true);
 
         if (VERBOSE)
-            cflp_success("Image loaded from cache: %dx%d", cached->width, cached->height);
+            cflp_success("Image loaded from cache: %dx%d", width, height);
         return;
     }
 
@@ -3026,128 +5540,704 @@ static void init_image_pipeline(void) {
                  NULL);
     gst_caps_unref(caps);
 
-    // Add elements to pipeline
-    gst_bin_add_many(GST_BIN(pipeline), filesrc, decoder, videoconvert, appsink, NULL);
+    // Add elements to pipeline
+    gst_bin_add_many(GST_BIN(pipeline), filesrc, decoder, videoconvert, appsink, NULL);
+
+    // Link filesrc to decoder
+    if (!gst_element_link(filesrc, decoder)) {
+        cflp_error("Failed to link filesrc to image decoder");
+        exit_slapper(EXIT_FAILURE);
+    }
+
+    // Link videoconvert to appsink
+    if (!gst_element_link(videoconvert, appsink)) {
+        cflp_error("Failed to link videoconvert to appsink");
+        exit_slapper(EXIT_FAILURE);
+    }
+
+    // gdkpixbufdec has static pads and links directly; decodebin needs dynamic pad linking
+    if (use_pixbuf_decoder) {
+        if (!gst_element_link(decoder, videoconvert)) {
+            cflp_error("Failed to link gdkpixbufdec to videoconvert");
+            exit_slapper(EXIT_FAILURE);
+        }
+    } else {
+        g_signal_connect(decoder, "pad-added", G_CALLBACK(on_decodebin_pad_added), videoconvert);
+    }
+
+    // Set up buffer probe on appsink
+    GstPad *sink_pad = gst_element_get_static_pad(appsink, "sink");
+    if (sink_pad) {
+        gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, NULL, NULL);
+        gst_object_unref(sink_pad);
+    }
+
+    // Get bus for messages
+    bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
+
+    // Start pipeline
+    GstStateChangeReturn ret = gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    if (ret == GST_STATE_CHANGE_FAILURE) {
+        cflp_error("Failed to start image pipeline");
+        exit_slapper(EXIT_FAILURE);
+    }
+
+    // Wait for the frame to be captured (with timeout)
+    int timeout_ms = 5000;
+    int waited = 0;
+    while (!image_frame_captured && waited < timeout_ms) {
+        // Handle shutdown signals arriving during the decode wait
+        process_pending_signal();
+
+        g_usleep(10000);  // 10ms
+        waited += 10;
+
+        // Process any pending bus messages
+        GstMessage *msg = gst_bus_pop(bus);
+        if (msg) {
+            if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+                GError *error = NULL;
+                gchar *debug = NULL;
+                gst_message_parse_error(msg, &error, &debug);
+                cflp_error("Image decode error: %s", error->message);
+                g_error_free(error);
+                g_free(debug);
+                gst_message_unref(msg);
+                exit_slapper(EXIT_FAILURE);
+            }
+            gst_message_unref(msg);
+        }
+    }
+
+    if (!image_frame_captured) {
+        cflp_error("Timeout waiting for image frame");
+        exit_slapper(EXIT_FAILURE);
+    }
+
+    // Stop pipeline (we have the frame in texture)
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+
+    // Add to cache for instant loading next time
+    pthread_mutex_lock(&video_mutex);
+    int width = video_frame_data.width;
+    int height = video_frame_data.height;
+    cached_frame_t *cache_frame = retain_image_frame_locked();
+    pthread_mutex_unlock(&video_mutex);
+    cache_image_frame(cache_frame, resolved_path, "", width, height);
+
+    if (VERBOSE)
+        cflp_success("Image loaded: %dx%d", width, height);
+}
+
+// GStreamer initialization
+// appsink caps for --upload copy: 4:2:0 YUV passes through from most decoders
+// and is converted in the fragment shader; RGBA remains for everything else
+#define APPSINK_COPY_CAPS "video/x-raw,format=(string){ NV12, I420, RGBA }"
+
+// appsink caps for --upload dmabuf: DMA-BUF RGBA (1.24+ DMA_DRM and legacy
+// form) preferred, system-memory RGBA kept so negotiation never fails
+#define APPSINK_DMABUF_CAPS \
+    "video/x-raw(memory:DMABuf),format=DMA_DRM,drm-format=AB24; " \
+    "video/x-raw(memory:DMABuf),format=RGBA; " \
+    "video/x-raw,format=RGBA"
+
+// Wrap appsink in a bin with a converter that can emit DMA-BUF RGBA.
+// Hardware decoders produce NV12/P010 in DMA-BUF or VA memory; vapostproc
+// converts on the GPU and exports DMA-BUF. Without it, videoconvert yields
+// system-memory RGBA and the copy path is used as before.
+static GstElement *make_dmabuf_video_sink(GstElement *app_sink) {
+    GstElement *bin = gst_bin_new("dmabuf-video-sink");
+    GstElement *convert = gst_element_factory_make("vapostproc", "dmabuf-convert");
+    if (!convert) {
+        cflp_warning("vapostproc not available, DMA-BUF frames limited to decoders that output RGBA");
+        convert = gst_element_factory_make("videoconvert", "dmabuf-convert");
+    }
+    gst_bin_add_many(GST_BIN(bin), convert, app_sink, NULL);
+    gst_element_link(convert, app_sink);
+
+    GstPad *pad = gst_element_get_static_pad(convert, "sink");
+    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad));
+    gst_object_unref(pad);
+    return bin;
+}
+
+// CHANGED 2026-10-16 - Crop invisible source pixels before convert/upload - Problem: fill mode
+// cropped with oversized vertices, so the hidden 25-40% on ultrawides was still uploaded per frame
+// Source rectangle that some output can actually show (mirrors update_vertex_data(): fill crops
+// to the display aspect, original clips to the output size, fit/stretch show everything).
+// The rectangle stays centered so the vertex math sees the same image center.
+// Caller holds decode_filter.lock.
+static void decode_visible_size_locked(int src_width, int src_height, int *vis_width, int *vis_height) {
+    *vis_width = src_width;
+    *vis_height = src_height;
+    if (decode_filter.n_outputs == 0 || (panscan_value != -1.0f && !fill_mode))
+        return;
+
+    int w = 0, h = 0;
+    for (int i = 0; i < decode_filter.n_outputs; i++) {
+        int ow = decode_filter.output_width[i];
+        int oh = decode_filter.output_height[i];
+        if (panscan_value == -1.0f) {
+            w = MAX(w, MIN(src_width, ow));
+            h = MAX(h, MIN(src_height, oh));
+        } else {
+            double video_aspect = (double)src_width / src_height;
+            double display_aspect = (double)ow / oh;
+            if (video_aspect > display_aspect) {
+                w = MAX(w, (int)(src_height * display_aspect + 0.5));
+                h = src_height;
+            } else {
+                w = src_width;
+                h = MAX(h, (int)(src_width / display_aspect + 0.5));
+            }
+        }
+    }
+    *vis_width = MIN(src_width, w);
+    *vis_height = MIN(src_height, h);
+}
+
+// Smallest uniform factor that still gives every output native-resolution
+// pixels for the current scaling mode (mirrors update_vertex_data()).
+// Caller holds decode_filter.lock.
+static double decode_scale_factor_locked(int src_width, int src_height) {
+    if (panscan_value == -1.0f)
+        return 1.0;  // original: pixels are shown 1:1
+
+    double factor = 0.0;
+    for (int i = 0; i < decode_filter.n_outputs; i++) {
+        int scale = decode_filter.output_scale[i];
+        double fx = (double)decode_filter.output_width[i] * scale / src_width;
+        double fy = (double)decode_filter.output_height[i] * scale / src_height;
+        double f;
+        if (fill_mode)
+            f = MAX(fx, fy);
+        else if (stretch_mode)
+            f = MAX(fx, fy) * panscan_value;
+        else
+            f = MIN(fx, fy) * panscan_value;
+        factor = MAX(factor, f);
+    }
+    return (factor > 0.0 && factor < 1.0) ? factor : 1.0;
+}
+
+// Caller holds decode_filter.lock
+static void update_decode_crop_locked(int *width, int *height) {
+    int vis_width, vis_height;
+    decode_visible_size_locked(*width, *height, &vis_width, &vis_height);
+
+    // Even offsets keep 4:2:0 chroma aligned
+    int crop_x = ((*width - vis_width) / 2) & ~1;
+    int crop_y = ((*height - vis_height) / 2) & ~1;
+    *width -= crop_x * 2;
+    *height -= crop_y * 2;
+    if (crop_x == decode_filter.crop_x && crop_y == decode_filter.crop_y)
+        return;
+    decode_filter.crop_x = crop_x;
+    decode_filter.crop_y = crop_y;
+
+    g_object_set(decode_filter.crop, "left", crop_x, "right", crop_x, "top", crop_y, "bottom", crop_y, NULL);
+    if (VERBOSE)
+        cflp_info("Decode crop: %dx%d -> %dx%d", decode_filter.source_width,
+                  decode_filter.source_height, *width, *height);
+}
+
+// Caller holds decode_filter.lock
+static void update_decode_filter_locked(void) {
+    if (!decode_filter.crop || decode_filter.n_outputs == 0 ||
+        decode_filter.source_width <= 0 || decode_filter.source_height <= 0)
+        return;
+
+    int crop_width = decode_filter.source_width;
+    int crop_height = decode_filter.source_height;
+    update_decode_crop_locked(&crop_width, &crop_height);
+
+    if (!decode_scale_enabled)
+        return;
+
+    int width = crop_width;
+    int height = crop_height;
+    double factor = decode_scale_factor_locked(width, height);
+    // Not worth a scaling pass for less than 10%
+    if (factor < 0.9) {
+        width = MAX(2, ((int)(width * factor + 0.5) + 1) & ~1);
+        height = MAX(2, ((int)(height * factor + 0.5) + 1) & ~1);
+    }
+    if (width == decode_filter.target_width && height == decode_filter.target_height)
+        return;
+    decode_filter.target_width = width;
+    decode_filter.target_height = height;
+
+    GstCaps *caps = (width == crop_width && height == crop_height) ?
+        gst_caps_new_any() :
+        gst_caps_new_simple("video/x-raw", "width", G_TYPE_INT, width, "height", G_TYPE_INT, height, NULL);
+    g_object_set(decode_filter.scale_caps, "caps", caps, NULL);
+    gst_caps_unref(caps);
+
+    if (VERBOSE)
+        cflp_info("Decode scale: %dx%d -> %dx%d", crop_width, crop_height, width, height);
+}
+
+// Learn the source size before the caps reach videocrop
+static GstPadProbeReturn decode_filter_caps_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    (void)pad;
+    (void)user_data;
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS)
+        return GST_PAD_PROBE_OK;
+
+    GstCaps *caps = NULL;
+    gst_event_parse_caps(event, &caps);
+    GstStructure *structure = gst_caps_get_structure(caps, 0);
+    int width = 0, height = 0;
+    gst_structure_get_int(structure, "width", &width);
+    gst_structure_get_int(structure, "height", &height);
+
+    pthread_mutex_lock(&decode_filter.lock);
+    decode_filter.source_width = width;
+    decode_filter.source_height = height;
+    update_decode_filter_locked();
+    pthread_mutex_unlock(&decode_filter.lock);
+    return GST_PAD_PROBE_OK;
+}
+
+// Snapshot configured output sizes and renegotiate the crop/scale if
+// needed. Main thread; call whenever outputs appear, change or go.
+static void refresh_decode_filter_outputs(struct wl_state *state) {
+    pthread_mutex_lock(&decode_filter.lock);
+    decode_filter.n_outputs = 0;
+    struct display_output *output;
+    wl_list_for_each(output, &state->outputs, link) {
+        if (output->width == 0 || output->height == 0 || !output->layer_surface)
+            continue;
+        if (decode_filter.n_outputs == DECODE_FILTER_MAX_OUTPUTS)
+            break;
+        decode_filter.output_width[decode_filter.n_outputs] = output->width;
+        decode_filter.output_height[decode_filter.n_outputs] = output->height;
+        decode_filter.output_scale[decode_filter.n_outputs] = output->scale;
+        decode_filter.n_outputs++;
+    }
+    update_decode_filter_locked();
+    pthread_mutex_unlock(&decode_filter.lock);
+}
+
+// Whether the current options can use the crop/scale stages at all
+static bool decode_filter_wanted(void) {
+    return decode_scale_enabled || fill_mode || panscan_value == -1.0f;
+}
+
+// Frames leaving the decoder, for the IPC stats command
+static GstPadProbeReturn decode_count_probe(GstPad *pad, GstPadProbeInfo *info, gpointer user_data) {
+    (void)pad;
+    (void)info;
+    (void)user_data;
+    count_render_stat(&render_stats.decoded);
+    return GST_PAD_PROBE_OK;
+}
+
+// Drop-only videorate, limited to the frame rate cap by apply_frame_rate_filter()
+static GstElement *make_rate_filter(void) {
+    GstElement *rate = gst_element_factory_make("videorate", "decode-rate");
+    if (!rate) {
+        cflp_warning("videorate not available, frames above the cap are dropped after conversion");
+        return NULL;
+    }
+    g_object_set(G_OBJECT(rate), "drop-only", TRUE, "silent", TRUE, NULL);
+    return rate;
+}
+
+// [videorate !] [videocrop ! videoscale ! capsfilter], installed as playbin's
+// video-filter. Every stage passes buffers through untouched until configured.
+// The crop/scale stages work on system memory only and are left out when
+// with_crop is false; videorate never touches frame data.
+static GstElement *make_decode_filter(bool with_crop) {
+    GstElement *rate = make_rate_filter();
+    GstElement *crop = NULL, *scale = NULL, *caps = NULL;
+    if (with_crop) {
+        crop = gst_element_factory_make("videocrop", "decode-crop");
+        scale = gst_element_factory_make("videoscale", "decode-scale");
+        caps = gst_element_factory_make("capsfilter", "decode-scale-caps");
+        if (!crop || !scale || !caps) {
+            cflp_warning("videocrop/videoscale not available, decoding full frames");
+            if (crop)
+                gst_object_unref(crop);
+            if (scale)
+                gst_object_unref(scale);
+            if (caps)
+                gst_object_unref(caps);
+            crop = scale = caps = NULL;
+        }
+    }
+    if (!rate && !crop)
+        return NULL;
+
+    GstElement *bin = gst_bin_new("decode-filter");
+    GstElement *first = rate ? rate : crop;
+    GstElement *last = crop ? caps : rate;
+    if (rate)
+        gst_bin_add(GST_BIN(bin), rate);
+    if (crop) {
+        gst_bin_add_many(GST_BIN(bin), crop, scale, caps, NULL);
+        gst_element_link_many(crop, scale, caps, NULL);
+        if (rate)
+            gst_element_link(rate, crop);
+
+        GstPad *crop_pad = gst_element_get_static_pad(crop, "sink");
+        gst_pad_add_probe(crop_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, decode_filter_caps_probe, NULL, NULL);
+        gst_object_unref(crop_pad);
+    }
+
+    GstPad *sink_pad = gst_element_get_static_pad(first, "sink");
+    gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER, decode_count_probe, NULL, NULL);
+    gst_element_add_pad(bin, gst_ghost_pad_new("sink", sink_pad));
+    gst_object_unref(sink_pad);
+    GstPad *src_pad = gst_element_get_static_pad(last, "src");
+    gst_element_add_pad(bin, gst_ghost_pad_new("src", src_pad));
+    gst_object_unref(src_pad);
+
+    // Keep our own refs: outputs may change after a pipeline is torn down
+    pthread_mutex_lock(&decode_filter.lock);
+    GstElement *old_rate = decode_filter.rate;
+    GstElement *old_crop = decode_filter.crop;
+    GstElement *old_caps = decode_filter.scale_caps;
+    if (old_rate) {
+        guint64 dropped = 0;
+        g_object_get(old_rate, "drop", &dropped, NULL);
+        decode_filter.rate_dropped += dropped;
+    }
+    decode_filter.rate = rate ? gst_object_ref(rate) : NULL;
+    decode_filter.crop = crop ? gst_object_ref(crop) : NULL;
+    decode_filter.scale_caps = caps ? gst_object_ref(caps) : NULL;
+    decode_filter.source_width = decode_filter.source_height = 0;
+    decode_filter.crop_x = decode_filter.crop_y = 0;
+    decode_filter.target_width = decode_filter.target_height = 0;
+    pthread_mutex_unlock(&decode_filter.lock);
+    if (old_rate)
+        gst_object_unref(old_rate);
+    if (old_crop)
+        gst_object_unref(old_crop);
+    if (old_caps)
+        gst_object_unref(old_caps);
+
+    apply_frame_rate_filter();
+    return bin;
+}
+
+// Frames dropped by videorate across all pipelines so far
+static uint64_t decode_rate_dropped(void) {
+    pthread_mutex_lock(&decode_filter.lock);
+    uint64_t dropped = decode_filter.rate_dropped;
+    if (decode_filter.rate) {
+        guint64 current = 0;
+        g_object_get(decode_filter.rate, "drop", &current, NULL);
+        dropped += current;
+    }
+    pthread_mutex_unlock(&decode_filter.lock);
+    return dropped;
+}
+
+// appsink caps for --upload gl: RGBA textures in GL memory
+#define APPSINK_GL_CAPS "video/x-raw(memory:GLMemory),format=RGBA,texture-target=2D"
+
+// glupload accepts system memory, DMA-BUF and GL memory from the decoder;
+// glcolorconvert does YUV -> RGBA on GStreamer's (shared) GL context.
+static GstElement *make_gl_video_sink(GstElement *app_sink) {
+    GstElement *bin = gst_bin_new("gl-video-sink");
+    GstElement *upload = gst_element_factory_make("glupload", "gl-upload");
+    GstElement *convert = gst_element_factory_make("glcolorconvert", "gl-convert");
+    if (!upload || !convert) {
+        cflp_warning("glupload/glcolorconvert not available (gst-plugins-base GL), using copy upload");
+        if (upload)
+            gst_object_unref(upload);
+        if (convert)
+            gst_object_unref(convert);
+        gst_object_unref(bin);
+        return NULL;
+    }
+    gst_bin_add_many(GST_BIN(bin), upload, convert, app_sink, NULL);
+    gst_element_link_many(upload, convert, app_sink, NULL);
+
+    GstPad *pad = gst_element_get_static_pad(upload, "sink");
+    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad));
+    gst_object_unref(pad);
+    return bin;
+}
 
-    // Link filesrc to decoder
-    if (!gst_element_link(filesrc, decoder)) {
-        cflp_error("Failed to link filesrc to image decoder");
-        exit_slapper(EXIT_FAILURE);
-    }
+// Hand our GL display and wrapped context to every GL element playbin
+// creates; bins pass contexts on to children added later.
+static void share_gl_context_with_pipeline(void) {
+    GstContext *display_context = gst_context_new(GST_GL_DISPLAY_CONTEXT_TYPE, TRUE);
+    gst_context_set_gl_display(display_context, gst_gl.display);
+    gst_element_set_context(pipeline, display_context);
+    gst_context_unref(display_context);
+
+    GstContext *app_context = gst_context_new("gst.gl.app_context", TRUE);
+    GstStructure *structure = gst_context_writable_structure(app_context);
+    gst_structure_set(structure, "context", GST_TYPE_GL_CONTEXT, gst_gl.app_context, NULL);
+    gst_element_set_context(pipeline, app_context);
+    gst_context_unref(app_context);
+}
 
-    // Link videoconvert to appsink
-    if (!gst_element_link(videoconvert, appsink)) {
-        cflp_error("Failed to link videoconvert to appsink");
-        exit_slapper(EXIT_FAILURE);
+// URI for playbin: URIs pass through, local paths become absolute file:// URIs.
+// Returns a malloc'd string, or NULL after logging why.
+static char *video_path_to_uri(const char *path) {
+    if (strstr(path, "://") != NULL)
+        return strdup(path);
+
+    // Local file, convert to absolute path first (fixes relative path issues)
+    char resolved_path[PATH_MAX];
+    if (realpath(path, resolved_path) == NULL) {
+        cflp_error("Failed to resolve path '%s': %s", path, strerror(errno));
+        return NULL;
     }
 
-    // gdkpixbufdec has static pads and links directly; decodebin needs dynamic pad linking
-    if (use_pixbuf_decoder) {
-        if (!gst_element_link(decoder, videoconvert)) {
-            cflp_error("Failed to link gdkpixbufdec to videoconvert");
-            exit_slapper(EXIT_FAILURE);
+    // Convert to file:// URI
+    size_t uri_len = strlen(resolved_path) + 8;
+    char *uri = malloc(uri_len);
+    if (!uri)
+        return NULL;
+    snprintf(uri, uri_len, "file://%s", resolved_path);
+
+    if (VERBOSE)
+        cflp_info("Resolved '%s' to '%s'", path, resolved_path);
+    return uri;
+}
+
+// A later restart (auto-stop, stoplist) should come back with the wallpaper shown now
+static void remember_restart_path(const char *new_path) {
+    if (halt_info.argv_copy && halt_info.argc > 0) {
+        char *arg = strdup(new_path);
+        if (arg) {
+            free(halt_info.argv_copy[halt_info.argc - 1]);
+            halt_info.argv_copy[halt_info.argc - 1] = arg;
         }
-    } else {
-        g_signal_connect(decoder, "pad-added", G_CALLBACK(on_decodebin_pad_added), videoconvert);
     }
+}
 
-    // Set up buffer probe on appsink
-    GstPad *sink_pad = gst_element_get_static_pad(appsink, "sink");
-    if (sink_pad) {
-        gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, NULL, NULL);
-        gst_object_unref(sink_pad);
+// Images default to fill mode unless a scaling option was given. In-process
+// changes between images and videos switch the default on and off, as the
+// process restart they replace did.
+static void apply_image_fill_default(bool image) {
+    if (image && !stretch_mode && panscan_value == 1.0f && !fill_mode) {
+        fill_mode = true;
+        fill_mode_defaulted = true;
+        if (VERBOSE)
+            cflp_info("Image detected, defaulting to fill mode");
+    } else if (!image && fill_mode_defaulted) {
+        fill_mode = false;
+        fill_mode_defaulted = false;
     }
+}
 
-    // Get bus for messages
-    bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
+// Per-file playback state for path, reset while the streaming threads are
+// stopped; position is where restore_video_position() seeks once playing
+static void reset_video_file_state(const char *path, double position) {
+    video_is_gif = is_gif_file(path);
+    if (video_is_gif && gif_loop_timer_fd < 0)
+        gif_loop_timer_fd = create_loop_timer();
+    if (gif_loop_timer_fd >= 0)
+        arm_loop_timer(gif_loop_timer_fd, 0, 0);
+    loop_segment_initialized = false;
+    restore_position = position;
+    probe_last_pts = GST_CLOCK_TIME_NONE;
+}
 
-    // Start pipeline
-    GstStateChangeReturn ret = gst_element_set_state(pipeline, GST_STATE_PLAYING);
-    if (ret == GST_STATE_CHANGE_FAILURE) {
-        cflp_error("Failed to start image pipeline");
-        exit_slapper(EXIT_FAILURE);
-    }
+// Drop queued messages (EOS, segment done, errors) that belong to the file just replaced
+static void flush_bus(void) {
+    if (!bus)
+        return;
+    gst_bus_set_flushing(bus, TRUE);
+    gst_bus_set_flushing(bus, FALSE);
+}
 
-    // Wait for the frame to be captured (with timeout)
-    int timeout_ms = 5000;
-    int waited = 0;
-    while (!image_frame_captured && waited < timeout_ms) {
-        // Handle shutdown signals arriving during the decode wait
-        process_pending_signal();
+// Point the playbin, stopped in READY, at another file and start it again
+static GstStateChangeReturn play_video_uri(const char *path, const char *uri, double position, GstState target) {
+    flush_bus();
+    reset_video_file_state(path, position);
+    pthread_mutex_lock(&frame_pacing.lock);
+    frame_pacing.flushing = false;
+    pthread_mutex_unlock(&frame_pacing.lock);
+    g_object_set(G_OBJECT(pipeline), "uri", uri, NULL);
+    return gst_element_set_state(pipeline, target);
+}
 
-        g_usleep(10000);  // 10ms
-        waited += 10;
+// The change has started: video_path and allocated_uri name the new file.
+// Keep the wallpaper it replaced (old_path, old_uri NULL for an image) until
+// the new file plays; a change superseding a pending one keeps the earlier
+// wallpaper, the last one known to play, and drops the unconfirmed one.
+static void begin_video_switch(char *old_path, char *old_uri, double old_position, GstState old_state) {
+    if (video_switch.active) {
+        answer_video_switch("ERROR: superseded by another change\n");
+        free(old_path);
+        free(old_uri);
+    } else {
+        video_switch.old_path = old_path;
+        video_switch.old_uri = old_uri;
+        video_switch.old_position = old_position;
+        video_switch.old_state = old_state;
+        video_switch.active = true;
+    }
+}
 
-        // Process any pending bus messages
-        GstMessage *msg = gst_bus_pop(bus);
-        if (msg) {
-            if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
-                GError *error = NULL;
-                gchar *debug = NULL;
-                gst_message_parse_error(msg, &error, &debug);
-                cflp_error("Image decode error: %s", error->message);
-                g_error_free(error);
-                g_free(debug);
-                gst_message_unref(msg);
-                exit_slapper(EXIT_FAILURE);
-            }
-            gst_message_unref(msg);
-        }
+// CHANGED 2026-10-16 - Switch videos inside the running process - Problem: `change` to another video
+// rewrote argv and restarted through the holder, tearing down the surfaces, EGL and GStreamer for
+// about a second of black screen plus a full startup. The playbin goes back to READY, gets the new
+// uri and plays again; appsink, probes, video-filter, textures and the cache all stay, and the old
+// frame stays on screen until the first new one is uploaded.
+// CHANGED 2026-10-16 - Name the new file only once it starts - Problem: a failed state change left
+// the playbin in READY with video_path and argv already naming the file that did not play
+static bool switch_video(const char *new_path) {
+    char *uri = video_path_to_uri(new_path);
+    char *path = strdup(new_path);
+    if (!uri || !path) {
+        free(uri);
+        free(path);
+        return false;
     }
 
-    if (!image_frame_captured) {
-        cflp_error("Timeout waiting for image frame");
-        exit_slapper(EXIT_FAILURE);
+    // Where the current video is, to go back to if the new one fails
+    GstState current = GST_STATE_VOID_PENDING, pending = GST_STATE_VOID_PENDING;
+    gst_element_get_state(pipeline, &current, &pending, 0);
+    GstState old_state = pending != GST_STATE_VOID_PENDING ? pending : current;
+    if (old_state != GST_STATE_PAUSED)
+        old_state = GST_STATE_PLAYING;
+    gint64 position = 0;
+    if (!gst_element_query_position(pipeline, GST_FORMAT_TIME, &position) || position < 0)
+        position = 0;
+
+    int64_t start_ns = monotonic_ns();
+    gst_element_set_state(pipeline, GST_STATE_READY);
+
+    GstState target = halt_info.is_paused > 0 ? GST_STATE_PAUSED : GST_STATE_PLAYING;
+    if (play_video_uri(path, uri, 0.0, target) == GST_STATE_CHANGE_FAILURE) {
+        cflp_error("Failed to start '%s'", new_path);
+        // video_path and allocated_uri still name the old file
+        gst_element_set_state(pipeline, GST_STATE_READY);
+        play_video_uri(video_path, allocated_uri, (double)position / GST_SECOND, old_state);
+        free(uri);
+        free(path);
+        return false;
     }
 
-    // Stop pipeline (we have the frame in texture)
-    gst_element_set_state(pipeline, GST_STATE_NULL);
+    begin_video_switch(video_path, allocated_uri, (double)position / GST_SECOND, old_state);
+    allocated_uri = uri;
+    video_path = path;
+    remember_restart_path(new_path);
+    video_switch_ns = start_ns;
+    if (VERBOSE)
+        cflp_info("Switching video to %s", new_path);
+    return true;
+}
 
-    // Add to cache for instant loading next time
-    if (cache_enabled() && video_frame_data.data) {
-        unsigned char *cache_copy = g_memdup2(video_frame_data.data, video_frame_data.size);
-        if (cache_copy) {
-            cache_add(resolved_path, cache_copy, video_frame_data.width, video_frame_data.height);
+// Send the result to the IPC client waiting on the video change, if any
+static void answer_video_switch(const char *response) {
+    if (video_switch.client_fd < 0)
+        return;
+    ipc_send_response(video_switch.client_fd, response);
+    close(video_switch.client_fd);
+    video_switch.client_fd = -1;
+}
+
+// Forget the pending video change (another change replaces the wallpaper)
+static void end_video_switch(void) {
+    if (video_switch.active)
+        answer_video_switch("ERROR: superseded by another change\n");
+    video_switch.active = false;
+    free(video_switch.old_path);
+    free(video_switch.old_uri);
+    video_switch.old_path = NULL;
+    video_switch.old_uri = NULL;
+}
+
+// The new file reached PAUSED: the change worked
+static void video_switch_done(void) {
+    answer_video_switch(transition_state.active ? "OK: transition started\n" : "OK\n");
+    video_switch.active = false;
+    end_video_switch();
+}
+
+// The new file failed to play: cancel the fade and go back to the wallpaper it replaced
+static void video_switch_failed(void) {
+    if (!video_switch.active)
+        return;
+    video_switch.active = false;
+    video_switch_ns = 0;
+    cancel_transition();  // Frees the captured frame
+
+    char *path = video_switch.old_path;
+    char *uri = video_switch.old_uri;
+    video_switch.old_path = NULL;
+    video_switch.old_uri = NULL;
+    cflp_warning("Could not play '%s', going back to '%s'", video_path, path);
+
+    if (uri) {
+        // Video to video: the same playbin plays the old file again
+        gst_element_set_state(pipeline, GST_STATE_READY);
+        free(allocated_uri);
+        allocated_uri = uri;
+        free(video_path);
+        video_path = path;
+        remember_restart_path(path);
+        if (play_video_uri(path, uri, video_switch.old_position, video_switch.old_state) == GST_STATE_CHANGE_FAILURE)
+            cflp_error("Failed to restart '%s'", path);
+    } else {
+        // Image to video: the image is still on screen; drop the playbin
+        stop_video_pipeline();
+        free(video_path);
+        video_path = path;
+        is_image_mode = true;
+        apply_image_fill_default(true);
+        remember_restart_path(path);
+        char resolved_path[PATH_MAX];
+        if (realpath(path, resolved_path))
             cache_set_displayed(resolved_path, true);
-        }
     }
+    answer_video_switch("ERROR: failed to switch video\n");
+}
 
-    if (VERBOSE)
-        cflp_success("Image loaded: %dx%d", video_frame_data.width, video_frame_data.height);
+// Stop and drop the current pipeline, whichever kind it is
+static void release_pipeline(void) {
+    if (!pipeline)
+        return;
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    if (bus) {
+        gst_object_unref(bus);
+        bus = NULL;
+    }
+    gst_object_unref(pipeline);
+    pipeline = NULL;
 }
 
-// GStreamer initialization
-static void init_gst(const struct wl_state *state) {
+// CHANGED 2026-10-16 - Return instead of exiting on failure - Problem: an image to video `change` starts the
+// playbin inside the running process, where a bad file must not take gSlapper down
+// Build the playbin for video_path and start it. At startup, wait for it to
+// reach PLAYING and restore the saved position; for a `change`, let the main
+// loop carry on (errors arrive on the bus). Returns false with no pipeline left.
+static bool start_video_pipeline(bool startup) {
     // Initialize GStreamer
     gst_init(NULL, NULL);
 
+    // Ranks must be in place before playbin autoplugs
+    if (decoder_policy != DECODER_AUTO && !apply_decoder_policy(decoder_policy)) {
+        cflp_error("--decoder hw-only: no hardware video decoders are installed");
+        return false;
+    }
+
     // Create playbin element (higher-level player)
     pipeline = gst_element_factory_make("playbin", "playbin");
     if (!pipeline) {
         cflp_error("Failed to create playbin element");
-        exit_slapper(EXIT_FAILURE);
+        return false;
     }
+    g_signal_connect(pipeline, "element-setup", G_CALLBACK(on_element_setup), NULL);
 
     // Set the URI - convert local file path to URI if needed
-    char *uri = video_path;
-    if (strstr(video_path, "://") == NULL) {
-        // Local file, convert to absolute path first (fixes relative path issues)
-        char resolved_path[PATH_MAX];
-        if (realpath(video_path, resolved_path) == NULL) {
-            cflp_error("Failed to resolve path '%s': %s", video_path, strerror(errno));
-            exit_slapper(EXIT_FAILURE);
-        }
-
-        // Convert to file:// URI
-        size_t uri_len = strlen(resolved_path) + 8;
-        uri = malloc(uri_len);
-        snprintf(uri, uri_len, "file://%s", resolved_path);
-        allocated_uri = uri;  // Track for cleanup
-
-        if (VERBOSE)
-            cflp_info("Resolved '%s' to '%s'", video_path, resolved_path);
+    free(allocated_uri);
+    allocated_uri = video_path_to_uri(video_path);  // Track for cleanup
+    if (!allocated_uri) {
+        release_pipeline();
+        return false;
     }
-    g_object_set(G_OBJECT(pipeline), "uri", uri, NULL);
+    g_object_set(G_OBJECT(pipeline), "uri", allocated_uri, NULL);
 
     // Set flags for video + audio playback by default
     gint flags = 0x00000003; // GST_PLAY_FLAG_VIDEO | GST_PLAY_FLAG_AUDIO
@@ -3157,7 +6247,20 @@ static void init_gst(const struct wl_state *state) {
     GstElement *app_sink = gst_element_factory_make("appsink", "app-sink");
     if (app_sink) {
         // Configure appsink to output RGBA frames
-        GstCaps *caps = gst_caps_from_string("video/x-raw,format=RGBA");
+        // CHANGED 2026-10-16 - Offer DMA-BUF RGBA first in --upload dmabuf mode - Problem: frames were always downloaded to system memory
+        // CHANGED 2026-10-16 - Accept decoder-native YUV in copy mode - Problem: CPU RGBA conversion was the heaviest stage
+        // CHANGED 2026-10-16 - GL memory caps in --upload gl mode - Problem: frames decoded to GL memory were downloaded to system RAM
+        GstElement *video_sink_bin = NULL;
+        if (gl_upload_active()) {
+            video_sink_bin = make_gl_video_sink(app_sink);
+            if (!video_sink_bin)
+                upload_mode = UPLOAD_MODE_COPY;
+        } else if (dmabuf_upload_active()) {
+            video_sink_bin = make_dmabuf_video_sink(app_sink);
+        }
+        GstCaps *caps = gst_caps_from_string(gl_upload_active() ? APPSINK_GL_CAPS :
+                                             dmabuf_upload_active() ? APPSINK_DMABUF_CAPS :
+                                             APPSINK_COPY_CAPS);
         g_object_set(G_OBJECT(app_sink), 
                      "caps", caps,
                      "emit-signals", TRUE,
@@ -3167,7 +6270,21 @@ static void init_gst(const struct wl_state *state) {
                      NULL);
         gst_caps_unref(caps);
         
-        g_object_set(G_OBJECT(pipeline), "video-sink", app_sink, NULL);
+        g_object_set(G_OBJECT(pipeline), "video-sink", video_sink_bin ? video_sink_bin : app_sink, NULL);
+        if (gl_upload_active())
+            share_gl_context_with_pipeline();
+
+        // videocrop/videoscale work on system memory only; the zero-copy paths keep GPU buffers
+        // CHANGED 2026-10-16 - Drop frames above the cap before conversion with videorate - Problem: surplus
+        // frames were converted and mapped in buffer_probe only to be overwritten in video_frame_data
+        bool with_crop = upload_mode == UPLOAD_MODE_COPY && decode_filter_wanted();
+        if (decode_scale_enabled && upload_mode != UPLOAD_MODE_COPY)
+            cflp_warning("--decode-scale only applies to --upload copy, decoding at source resolution");
+        if (!is_image_mode || with_crop) {
+            GstElement *filter = make_decode_filter(with_crop);
+            if (filter)
+                g_object_set(G_OBJECT(pipeline), "video-filter", filter, NULL);
+        }
         
         using_waylandsink = false;  // We'll handle rendering manually
         if (VERBOSE)
@@ -3191,28 +6308,45 @@ static void init_gst(const struct wl_state *state) {
         }
     }
 
-    // Get bus for messages
+    // Get bus for messages; the main loop polls its fd and dispatches them
     bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
-    gst_bus_add_watch(bus, bus_callback, NULL);
 
     // Apply GStreamer options
     apply_gst_options();
+    if (gapless_loop)
+        g_signal_connect(pipeline, "about-to-finish", G_CALLBACK(on_about_to_finish), NULL);
 
     // Set up buffer probe to capture video frames from appsink
     GstElement *video_sink = NULL;
     g_object_get(G_OBJECT(pipeline), "video-sink", &video_sink, NULL);
     if (video_sink) {
+        // The DMA-BUF sink is a converter bin; probe the appsink itself so the
+        // probe sees the negotiated RGBA caps rather than the decoder's
+        if (GST_IS_BIN(video_sink)) {
+            GstElement *inner = gst_bin_get_by_name(GST_BIN(video_sink), "app-sink");
+            if (inner) {
+                gst_object_unref(video_sink);
+                video_sink = inner;
+            }
+        }
         // Get the sink pad to add the probe
         GstPad *sink_pad = gst_element_get_static_pad(video_sink, "sink");
         if (sink_pad) {
             gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER, buffer_probe, NULL, NULL);
+            // A pipeline torn down mid-flush never sends FLUSH_STOP
+            pthread_mutex_lock(&frame_pacing.lock);
+            frame_pacing.flushing = false;
+            pthread_mutex_unlock(&frame_pacing.lock);
+            gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+                              frame_pacing_flush_probe, NULL, NULL);
             gst_object_unref(sink_pad);
         }
         gst_object_unref(video_sink);
     }
 
-    // Start playing
-    GstStateChangeReturn ret = gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    // Start playing; a `change` keeps pause holds other than IPC's (pauselist)
+    GstState target = !startup && halt_info.is_paused > 0 ? GST_STATE_PAUSED : GST_STATE_PLAYING;
+    GstStateChangeReturn ret = gst_element_set_state(pipeline, target);
     
     // Handle the state change result properly
     if (ret == GST_STATE_CHANGE_FAILURE) {
@@ -3222,7 +6356,7 @@ static void init_gst(const struct wl_state *state) {
         // Get more detailed error information
         GError *error = NULL;
         gchar *debug = NULL;
-        GstMessage *msg = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE, GST_MESSAGE_ERROR);
+        GstMessage *msg = gst_bus_timed_pop_filtered(bus, startup ? GST_CLOCK_TIME_NONE : 0, GST_MESSAGE_ERROR);
         
         if (msg) {
             gst_message_parse_error(msg, &error, &debug);
@@ -3235,8 +6369,9 @@ static void init_gst(const struct wl_state *state) {
             gst_message_unref(msg);
         }
         
-        exit_slapper(EXIT_FAILURE);
-    } else {
+        release_pipeline();
+        return false;
+    } else if (startup) {
         // Either GST_STATE_CHANGE_ASYNC (normal) or GST_STATE_CHANGE_SUCCESS (immediate)
         if (VERBOSE) {
             if (ret == GST_STATE_CHANGE_ASYNC) {
@@ -3255,7 +6390,8 @@ static void init_gst(const struct wl_state *state) {
                 cflp_error("  Arch: sudo pacman -S gst-plugins-ugly gst-libav");
                 cflp_error("  Ubuntu: sudo apt install gstreamer1.0-plugins-ugly gstreamer1.0-libav");
                 cflp_error("Or run with GST_DEBUG=3 for more details");
-                exit_slapper(EXIT_FAILURE);
+                release_pipeline();
+                return false;
             }
         }
         
@@ -3286,9 +6422,205 @@ static void init_gst(const struct wl_state *state) {
 
     if (VERBOSE)
         cflp_info("Loaded %s", video_path);
+    return true;
+}
+
+// CHANGED 2026-10-16 - Change between images and videos inside the running process - Problem: these changes
+// rewrote argv and restarted through stop_slapper(), cutting to black with no transition and needing
+// --auto-stop. The old frame now stays in texture_manager (and in the transition capture) until the
+// new pipeline uploads its first frame.
+// Image to video change: drop the image pipeline and start a playbin for new_path
+static bool switch_to_video(const char *new_path) {
+    char *path = strdup(new_path);
+    if (!path)
+        return false;
+
+    // A change still decoding is replaced by this one
+    if (image_load.active) {
+        image_load.active = false;
+        if (image_load.timer_fd >= 0)
+            arm_loop_timer(image_load.timer_fd, 0, 0);
+        answer_image_load("ERROR: superseded by another change\n");
+    }
+
+    char old_resolved_path[PATH_MAX];
+    bool old_resolved = video_path && realpath(video_path, old_resolved_path);
+    release_pipeline();
+
+    // The IPC pause applied to the image; start the video fresh, as the
+    // process restart this replaces did
+    if (ipc_paused) {
+        ipc_paused = false;
+        if (halt_info.is_paused > 0) halt_info.is_paused--;
+    }
+
+    // start_video_pipeline() plays video_path
+    char *old_path = video_path;
+    video_path = path;
+    is_image_mode = false;
+    apply_image_fill_default(false);
+    reset_video_file_state(path, 0.0);
+
+    int64_t start_ns = monotonic_ns();
+    if (!start_video_pipeline(false)) {
+        cflp_error("Failed to start '%s'", new_path);
+        // Still showing the image; no pipeline is left
+        video_path = old_path;
+        free(path);
+        is_image_mode = true;
+        apply_image_fill_default(true);
+        video_is_gif = false;
+        return false;
+    }
+
+    if (old_resolved)
+        cache_set_displayed(old_resolved_path, false);
+    begin_video_switch(old_path, NULL, 0.0, GST_STATE_PLAYING);
+    remember_restart_path(new_path);
+    video_switch_ns = start_ns;
+    if (VERBOSE)
+        cflp_info("Switching from image to video %s", new_path);
+    return true;
+}
+
+// Video to image change: stop the playbin and drop per-video state before
+// reload_image_pipeline() builds the image pipeline. The last video frame
+// stays on screen until the image is uploaded.
+static void stop_video_pipeline(void) {
+    end_video_switch();
+    release_pipeline();
+
+    // update_visibility() skips images, so it would never release its hold
+    pthread_mutex_lock(&visibility.lock);
+    bool suspended = visibility.suspended;
+    visibility.suspended = false;
+    visibility.wake = false;
+    visibility.measuring = false;
+    pthread_mutex_unlock(&visibility.lock);
+    if (suspended && halt_info.is_paused > 0)
+        halt_info.is_paused--;
+
+    video_is_gif = false;
+    if (gif_loop_timer_fd >= 0)
+        arm_loop_timer(gif_loop_timer_fd, 0, 0);
+    loop_segment_initialized = false;
+    probe_last_pts = GST_CLOCK_TIME_NONE;
+    video_switch_ns = 0;
+    pthread_mutex_lock(&decoder_mutex);
+    active_decoder[0] = '\0';
+    pthread_mutex_unlock(&decoder_mutex);
+}
+
+static void init_gst(const struct wl_state *state) {
+    (void)state;
+    if (!start_video_pipeline(true))
+        exit_slapper(EXIT_FAILURE);
 }
 
 // EGL initialization (copied from mpvpaper)
+// Resolve the DMA-BUF import entry points. Leaves egl_dmabuf.supported FALSE
+// (copy upload) if the driver lacks EGL_EXT_image_dma_buf_import.
+static void init_egl_dmabuf(void) {
+    const char *exts = eglQueryString(egl_display, EGL_EXTENSIONS);
+    if (!exts || !strstr(exts, "EGL_EXT_image_dma_buf_import")) {
+        cflp_warning("EGL_EXT_image_dma_buf_import not supported, falling back to copy upload");
+        return;
+    }
+
+    egl_dmabuf.create_image = (egl_create_image_khr_fn)eglGetProcAddress("eglCreateImageKHR");
+    egl_dmabuf.destroy_image = (egl_destroy_image_khr_fn)eglGetProcAddress("eglDestroyImageKHR");
+    egl_dmabuf.image_target_texture =
+        (gl_egl_image_target_texture_2d_fn)eglGetProcAddress("glEGLImageTargetTexture2DOES");
+    if (!egl_dmabuf.create_image || !egl_dmabuf.destroy_image || !egl_dmabuf.image_target_texture) {
+        cflp_warning("EGLImage entry points unavailable, falling back to copy upload");
+        return;
+    }
+
+    egl_dmabuf.modifiers = strstr(exts, "EGL_EXT_image_dma_buf_import_modifiers") != NULL;
+    egl_dmabuf.supported = TRUE;
+    if (VERBOSE)
+        cflp_info("DMA-BUF import available (modifiers: %s)", egl_dmabuf.modifiers ? "yes" : "no");
+}
+
+// Resolve the fence entry points used to hand frames to render threads.
+// Without them uploads and draws fall back to glFinish().
+static void init_render_threads(void) {
+    const char *exts = eglQueryString(egl_display, EGL_EXTENSIONS);
+    if (exts && strstr(exts, "EGL_KHR_fence_sync") && strstr(exts, "EGL_KHR_wait_sync")) {
+        render_threads.create_sync = (egl_create_sync_khr_fn)eglGetProcAddress("eglCreateSyncKHR");
+        render_threads.destroy_sync = (egl_destroy_sync_khr_fn)eglGetProcAddress("eglDestroySyncKHR");
+        render_threads.client_wait_sync = (egl_client_wait_sync_khr_fn)eglGetProcAddress("eglClientWaitSyncKHR");
+        render_threads.wait_sync = (egl_wait_sync_khr_fn)eglGetProcAddress("eglWaitSyncKHR");
+        render_threads.fence_sync = render_threads.create_sync && render_threads.destroy_sync &&
+                                    render_threads.client_wait_sync && render_threads.wait_sync;
+    }
+    if (!render_threads.fence_sync)
+        cflp_warning("EGL fence sync not supported, render threads will synchronize with glFinish()");
+    else if (VERBOSE)
+        cflp_info("Threaded rendering enabled (EGL fence sync)");
+}
+
+// Wrap our EGL display and context for GStreamer's GL elements. Leaves
+// gst_gl.app_context NULL (copy upload) on failure.
+static void init_gst_gl_context(GstGLAPI api) {
+    gst_init(NULL, NULL);
+
+    gst_gl.display = GST_GL_DISPLAY(gst_gl_display_egl_new_with_egl_display(egl_display));
+    if (!gst_gl.display) {
+        cflp_warning("Failed to create GStreamer GL display, falling back to copy upload");
+        return;
+    }
+    gst_gl.app_context = gst_gl_context_new_wrapped(gst_gl.display, (guintptr)egl_context,
+                                                    GST_GL_PLATFORM_EGL, api);
+    GError *error = NULL;
+    if (!gst_gl.app_context || !gst_gl_context_activate(gst_gl.app_context, TRUE) ||
+        !gst_gl_context_fill_info(gst_gl.app_context, &error)) {
+        cflp_warning("Failed to wrap EGL context for GStreamer GL (%s), falling back to copy upload",
+                     error ? error->message : "activation failed");
+        g_clear_error(&error);
+        if (gst_gl.app_context)
+            gst_object_unref(gst_gl.app_context);
+        gst_object_unref(gst_gl.display);
+        gst_gl.app_context = NULL;
+        gst_gl.display = NULL;
+        return;
+    }
+    if (VERBOSE)
+        cflp_info("Shared EGL context with GStreamer GL");
+}
+
+static bool has_gl_extension(const char *name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++) {
+        const char *ext = (const char *)glGetStringi(GL_EXTENSIONS, i);
+        if (ext && strcmp(ext, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Pick the compressed format cached images are stored in (--cache-compress auto).
+// Only formats desktop drivers can encode on upload qualify: BPTC (4:1, keeps
+// quality) and S3TC DXT1 (8:1, no alpha). Without either, the cache falls
+// back to zstd.
+static void choose_cache_gpu_format(void) {
+    if (cache_compress_mode != CACHE_COMPRESS_AUTO || !cache_enabled())
+        return;
+    if (GLAD_GL_VERSION_4_2 || has_gl_extension("GL_ARB_texture_compression_bptc"))
+        cache_gpu_format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+    else if (has_gl_extension("GL_EXT_texture_compression_s3tc"))
+        cache_gpu_format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    if (VERBOSE) {
+        if (cache_gpu_format)
+            cflp_info("Caching images as %s textures",
+                      cache_gpu_format == GL_COMPRESSED_RGBA_BPTC_UNORM ? "BPTC" : "S3TC DXT1");
+        else
+            cflp_info("No encodable compressed texture format, caching images %s",
+                      cache_lossless_available() ? "with zstd" : "uncompressed");
+    }
+}
+
 static void init_egl(struct wl_state *state) {
     egl_display = eglGetPlatformDisplay(EGL_PLATFORM_WAYLAND_KHR, state->display, NULL);
     if (egl_display == EGL_NO_DISPLAY) {
@@ -3336,11 +6668,13 @@ static void init_egl(struct wl_state *state) {
         if (egl_context) {
             if (VERBOSE)
                 cflp_info("OpenGL %i.%i Compatibility EGL context created", gl_versions[i].major, gl_versions[i].minor);
+            memcpy(render_threads.context_attrib, ctx_attrib, sizeof(ctx_attrib));
             break;
         }
     }
     
     // Fallback to core context if compatibility fails
+    bool core_context = !egl_context;
     if (!egl_context) {
         for (uint i=0; gl_versions[i].major > 0; i++) {
             const EGLint ctx_attrib[] = {
@@ -3352,6 +6686,7 @@ static void init_egl(struct wl_state *state) {
             if (egl_context) {
                 if (VERBOSE)
                     cflp_info("OpenGL %i.%i Core EGL context created", gl_versions[i].major, gl_versions[i].minor);
+                memcpy(render_threads.context_attrib, ctx_attrib, sizeof(ctx_attrib));
                 break;
             }
         }
@@ -3373,13 +6708,38 @@ static void init_egl(struct wl_state *state) {
     
     // Initialize smart texture manager
     init_texture_manager();
+    choose_cache_gpu_format();
+
+    const char *egl_exts = eglQueryString(egl_display, EGL_EXTENSIONS);
+    if (egl_exts && strstr(egl_exts, "EGL_KHR_swap_buffers_with_damage"))
+        egl_swap_with_damage = (egl_swap_buffers_with_damage_fn)eglGetProcAddress("eglSwapBuffersWithDamageKHR");
+    else if (egl_exts && strstr(egl_exts, "EGL_EXT_swap_buffers_with_damage"))
+        egl_swap_with_damage = (egl_swap_buffers_with_damage_fn)eglGetProcAddress("eglSwapBuffersWithDamageEXT");
+    if (VERBOSE && egl_swap_with_damage)
+        cflp_info("Partial damage available (swap buffers with damage)");
+
+    if (upload_mode == UPLOAD_MODE_DMABUF)
+        init_egl_dmabuf();
+    else if (upload_mode == UPLOAD_MODE_GL)
+        init_gst_gl_context(core_context ? GST_GL_API_OPENGL3 : GST_GL_API_OPENGL);
+
+    if (render_threads.enabled)
+        init_render_threads();
 }
 
 // Wayland output management (copied from mpvpaper)
 static void destroy_display_output(struct display_output *output) {
     if (!output)
         return;
+    stop_render_thread(output);
     wl_list_remove(&output->link);
+
+    // Let the next presented frame on another output take over the vblank grid
+    pthread_mutex_lock(&frame_pacing.lock);
+    if (frame_pacing.output_name == output->wl_name)
+        frame_pacing.refresh_ns = 0;
+    pthread_mutex_unlock(&frame_pacing.lock);
+
     if (output->layer_surface != NULL)
         zwlr_layer_surface_v1_destroy(output->layer_surface);
     if (output->surface != NULL)
@@ -3390,9 +6750,15 @@ static void destroy_display_output(struct display_output *output) {
         wl_egl_window_destroy(output->egl_window);
     wl_output_destroy(output->wl_output);
 
+    struct wl_state *state = output->state;
     free(output->name);
     free(output->identifier);
     free(output);
+
+    if (state) {
+        refresh_decode_filter_outputs(state);
+        refresh_fastest_output_rate(state);
+    }
 }
 
 static void layer_surface_configure(void *data, struct zwlr_layer_surface_v1 *surface, uint32_t serial, uint32_t width,
@@ -3431,8 +6797,17 @@ static void layer_surface_configure(void *data, struct zwlr_layer_surface_v1 *su
         // Start render loop
         render(output);
     } else {
+        // The render thread may be mid-swap on this window
+        stop_render_thread(output);
+        // Reconfigured outputs are about to be shown; don't hold an old callback against them
+        pthread_mutex_lock(&visibility.lock);
+        output->frame_request_ns = 0;
+        pthread_mutex_unlock(&visibility.lock);
         wl_egl_window_resize(output->egl_window, output->width * output->scale, output->height * output->scale, 0, 0);
     }
+
+    refresh_decode_filter_outputs(output->state);
+    sync_render_threads(output->state);
 }
 
 static void layer_surface_closed(void *data, struct zwlr_layer_surface_v1 *surface) {
@@ -3482,7 +6857,14 @@ static void output_geometry(void *data, struct wl_output *wl_output, int32_t x,
 
 static void output_mode(void *data, struct wl_output *wl_output, uint32_t flags, int32_t width, int32_t height,
         int32_t refresh) {
-    // NOP
+    (void)wl_output; (void)width; (void)height;
+
+    // Only the refresh rate matters, as the clamp for --fps-cap auto
+    struct display_output *output = data;
+    if (flags & WL_OUTPUT_MODE_CURRENT) {
+        output->refresh_mhz = refresh;
+        refresh_fastest_output_rate(output->state);
+    }
 }
 
 static void output_done(void *data, struct wl_output *wl_output) {
@@ -3554,6 +6936,61 @@ static const struct wl_output_listener output_listener = {
     .description = output_description,
 };
 
+static void presentation_clock_id(void *data, struct wp_presentation *presentation, uint32_t clk_id) {
+    (void)data; (void)presentation;
+    // Feedback timestamps are compared against CLOCK_MONOTONIC in buffer_probe
+    frame_pacing.clock_monotonic = clk_id == CLOCK_MONOTONIC;
+    if (VERBOSE)
+        cflp_info("Presentation timing available (%s clock)%s", clk_id == CLOCK_MONOTONIC ? "monotonic" : "non-monotonic",
+                  frame_pacing.clock_monotonic ? "" : ", frames will not be aligned to vblanks");
+}
+
+static const struct wp_presentation_listener presentation_listener = {
+    .clock_id = presentation_clock_id,
+};
+
+#ifdef HAVE_EXT_IDLE_NOTIFY
+static void idle_notification_idled(void *data, struct ext_idle_notification_v1 *notification) {
+    (void)data; (void)notification;
+    pthread_mutex_lock(&visibility.lock);
+    visibility.idle = true;
+    pthread_mutex_unlock(&visibility.lock);
+}
+
+static void idle_notification_resumed(void *data, struct ext_idle_notification_v1 *notification) {
+    (void)data; (void)notification;
+    pthread_mutex_lock(&visibility.lock);
+    visibility.idle = false;
+    pthread_mutex_unlock(&visibility.lock);
+}
+
+static const struct ext_idle_notification_v1_listener idle_notification_listener = {
+    .idled = idle_notification_idled,
+    .resumed = idle_notification_resumed,
+};
+#endif
+
+// --idle-pause: ask the compositor to tell us when the seat goes idle
+static void init_idle_notification(struct wl_state *state) {
+    if (!visibility.idle_timeout_ms)
+        return;
+#ifdef HAVE_EXT_IDLE_NOTIFY
+    if (state->idle_notifier && state->seat) {
+        struct ext_idle_notification_v1 *notification = ext_idle_notifier_v1_get_idle_notification(
+            state->idle_notifier, visibility.idle_timeout_ms, state->seat);
+        ext_idle_notification_v1_add_listener(notification, &idle_notification_listener, state);
+        if (VERBOSE)
+            cflp_info("Pausing after %u s without input", visibility.idle_timeout_ms / 1000);
+        return;
+    }
+    cflp_warning("Compositor does not support ext-idle-notify-v1, --idle-pause ignored");
+#else
+    (void)state;
+    cflp_warning("Built without ext-idle-notify-v1 support, --idle-pause ignored");
+#endif
+    visibility.idle_timeout_ms = 0;
+}
+
 static void handle_global(void *data, struct wl_registry *registry, uint32_t name, const char *interface,
         uint32_t version) {
     struct wl_state *state = data;
@@ -3572,6 +7009,15 @@ static void handle_global(void *data, struct wl_registry *registry, uint32_t nam
         // CHANGED 2026-02-21 04:00 - Negotiate layer-shell bind version up to v2 - Problem: keep compatibility with compositors that only expose v1
         uint32_t bind_version = version < 2 ? version : 2;
         state->layer_shell = wl_registry_bind(registry, name, &zwlr_layer_shell_v1_interface, bind_version);
+    } else if (strcmp(interface, wp_presentation_interface.name) == 0) {
+        state->presentation = wl_registry_bind(registry, name, &wp_presentation_interface, 1);
+        wp_presentation_add_listener(state->presentation, &presentation_listener, state);
+    } else if (strcmp(interface, wl_seat_interface.name) == 0 && !state->seat) {
+        state->seat = wl_registry_bind(registry, name, &wl_seat_interface, 1);
+#ifdef HAVE_EXT_IDLE_NOTIFY
+    } else if (strcmp(interface, ext_idle_notifier_v1_interface.name) == 0) {
+        state->idle_notifier = wl_registry_bind(registry, name, &ext_idle_notifier_v1_interface, 1);
+#endif
     }
 }
 
@@ -3691,6 +7137,13 @@ static void parse_command_line(int argc, char **argv, struct wl_state *state) {
         {"state-file", required_argument, NULL, 1001},
         {"no-save-state", no_argument, NULL, 1002},
         {"cache-size", required_argument, NULL, 1003},
+        {"upload", required_argument, NULL, 1004},
+        {"decoder", required_argument, NULL, 1005},
+        {"decode-scale", no_argument, NULL, 1006},
+        {"threaded-render", no_argument, NULL, 1007},
+        {"idle-pause", required_argument, NULL, 1008},
+        {"disk-cache", required_argument, NULL, 1009},
+        {"cache-compress", required_argument, NULL, 1010},
         {0, 0, 0, 0}
     };
 
@@ -3710,7 +7163,7 @@ static void parse_command_line(int argc, char **argv, struct wl_state *state) {
         "--slideshow    -n SECS         Slideshow mode plays the next video in a playlist every ? seconds\n"
         "--layer        -l LAYER        Specifies shell surface layer to run on (background by default)\n"
         "--gst-options  -o \"OPTIONS\"    Forwards GStreamer options (Must be within quotes\"\")\n"
-        "--fps-cap      -r FPS           Frame rate cap (30, 60, or 100 FPS, default: 30)\n"
+        "--fps-cap      -r FPS           Frame rate cap (1-1000 or auto, default: 30)\n"
         "--ipc-socket   -I PATH          Enable IPC control via Unix socket\n"
         "--transition-type TYPE          Transition effect (fade, none, default: none)\n"
         "--transition-duration SECS      Transition duration in seconds (default: 0.5)\n"
@@ -3720,6 +7173,13 @@ static void parse_command_line(int argc, char **argv, struct wl_state *state) {
         "--state-file PATH              Use a custom state file path\n"
         "--no-save-state                Disable automatic state saving on exit\n"
         "--cache-size MB                 Image cache size in MB (default: 256, 0 to disable)\n"
+        "--upload MODE                   Video frame upload path (copy, dmabuf, gl, default: copy)\n"
+        "--decoder MODE                  Video decoder choice (auto, hw, hw-only, sw, default: auto)\n"
+        "--decode-scale                  Downscale video in the pipeline to the largest output size\n"
+        "--threaded-render               Draw each output on its own thread (video only)\n"
+        "--idle-pause SECS               Pause video after SECS without input (ext-idle-notify-v1)\n"
+        "--disk-cache MB                 Keep decoded images on disk, up to MB (default: 0, off)\n"
+        "--cache-compress MODE           Compress cached images: off, auto (GPU texture format), lossless (default: off)\n"
         "\n"
         "Scaling modes (use with -o):\n"
         "  fill        Fill screen maintaining aspect ratio, crop excess (default for images)\n"
@@ -3727,6 +7187,10 @@ static void parse_command_line(int argc, char **argv, struct wl_state *state) {
         "  original    Display at native resolution\n"
         "  panscan=X   Fit inside screen with scaling factor 0.0-1.0 (default for video)\n"
         "\n"
+        "Loop modes (use with -o):\n"
+        "  loop          Loop with segment seeks\n"
+        "  loop=gapless  Loop by prerolling the file again on a second decoder\n"
+        "\n"
         "Supported formats:\n"
         "  Video: MP4, MKV, WebM, AVI, MOV, and other GStreamer-supported formats\n"
         "  Image: JPEG, PNG, WebP, GIF\n";
@@ -3802,8 +7266,15 @@ static void parse_command_line(int argc, char **argv, struct wl_state *state) {
                 }
                 break;
             case 'r':
-                set_frame_rate_cap(atoi(optarg));
+            {
+                int fps;
+                if (!parse_frame_rate_cap(optarg, &fps)) {
+                    cflp_warning("Invalid frame rate cap %s, using 30 FPS", optarg);
+                    fps = 30;
+                }
+                set_frame_rate_cap(fps);
                 break;
+            }
             case 'I':
                 ipc_socket_path = strdup(optarg);
                 break;
@@ -3863,6 +7334,67 @@ static void parse_command_line(int argc, char **argv, struct wl_state *state) {
                     }
                 }
                 break;
+            case 1004: // --upload
+                if (strcmp(optarg, "copy") == 0) {
+                    upload_mode = UPLOAD_MODE_COPY;
+                } else if (strcmp(optarg, "dmabuf") == 0) {
+                    upload_mode = UPLOAD_MODE_DMABUF;
+                } else if (strcmp(optarg, "gl") == 0) {
+                    upload_mode = UPLOAD_MODE_GL;
+                } else {
+                    cflp_warning("Invalid upload mode '%s', using copy", optarg);
+                    upload_mode = UPLOAD_MODE_COPY;
+                }
+                break;
+            case 1005: // --decoder
+                {
+                    int policy;
+                    if (parse_decoder_policy(optarg, &policy)) {
+                        decoder_policy = policy;
+                    } else {
+                        cflp_warning("Invalid decoder mode '%s', using auto", optarg);
+                    }
+                }
+                break;
+            case 1006: // --decode-scale
+                decode_scale_enabled = true;
+                break;
+            case 1007: // --threaded-render
+                render_threads.enabled = true;
+                break;
+            case 1008: // --idle-pause
+                {
+                    char *end;
+                    long secs = strtol(optarg, &end, 10);
+                    if (end == optarg || *end != '\0' || secs < 1 || secs > 86400) {
+                        cflp_warning("Invalid idle timeout '%s', idle pause disabled", optarg);
+                    } else {
+                        visibility.idle_timeout_ms = (uint32_t)secs * 1000;
+                    }
+                }
+                break;
+            case 1009: // --disk-cache
+                {
+                    char *end;
+                    long size = strtol(optarg, &end, 10);
+                    if (end == optarg || *end != '\0' || size < 0 || size > 1024 * 1024) {
+                        cflp_warning("Invalid disk cache size '%s', disk cache disabled", optarg);
+                    } else {
+                        disk_cache_mb = (size_t)size;
+                    }
+                }
+                break;
+            case 1010: // --cache-compress
+                if (strcmp(optarg, "off") == 0) {
+                    cache_compress_mode = CACHE_COMPRESS_OFF;
+                } else if (strcmp(optarg, "auto") == 0) {
+                    cache_compress_mode = CACHE_COMPRESS_AUTO;
+                } else if (strcmp(optarg, "lossless") == 0) {
+                    cache_compress_mode = CACHE_COMPRESS_LOSSLESS;
+                } else {
+                    cflp_warning("Invalid cache compression '%s', using off", optarg);
+                }
+                break;
         }
     }
 
@@ -3897,13 +7429,13 @@ static void parse_command_line(int argc, char **argv, struct wl_state *state) {
 
 static void check_paper_processes() {
     // Check for other wallpaper process running
-    const char *other_wallpapers[] = {"swaybg", "glpaper", "hyprpaper", "wpaperd", "swww-daemon"};
-    char wallpaper_sbuffer[64] = {0};
+    char *other_wallpapers[] = {"swaybg", "glpaper", "hyprpaper", "wpaperd", "swww-daemon", NULL};
+    bool running[sizeof(other_wallpapers) / sizeof(other_wallpapers[0])] = {0};
 
-    for (int i=0; i < sizeof(other_wallpapers) / sizeof(other_wallpapers[0]); i++) {
-        snprintf(wallpaper_sbuffer, sizeof(wallpaper_sbuffer), "pidof %s > /dev/null", other_wallpapers[i]);
-
-        if (!system(wallpaper_sbuffer))
+    if (!procmon_scan(other_wallpapers, running))
+        return;
+    for (int i=0; other_wallpapers[i] != NULL; i++) {
+        if (running[i])
             cflp_warning("%s is running. This may block slapper from being seen.", other_wallpapers[i]);
     }
 }
@@ -3945,6 +7477,8 @@ int main(int argc, char **argv) {
 
     // Initialize image cache
     cache_init(cache_size_mb);
+    cache_set_compression(cache_compress_mode);
+    diskcache_init(disk_cache_mb);
 
     // Handle --save-state flag (save and exit immediately)
     if (save_state_flag) {
@@ -3977,13 +7511,12 @@ int main(int argc, char **argv) {
     if (halt_info.auto_stop || halt_info.stoplist)
         copy_argv(argc, argv);
 
-    // Create pipe for checking render_update_callback()
-    if (pipe(wakeup_pipe) == -1) {
-        cflp_error("Creating a self-pipe failed.");
+    // Create eventfd for waking the main loop from GStreamer and render threads
+    wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeup_fd == -1) {
+        cflp_error("Creating the wakeup eventfd failed.");
         return EXIT_FAILURE;
     }
-    fcntl(wakeup_pipe[0], F_SETFD, FD_CLOEXEC);
-    fcntl(wakeup_pipe[1], F_SETFD, FD_CLOEXEC);
 
     // Connect to Wayland compositor
     state.display = wl_display_connect(NULL);
@@ -4008,11 +7541,7 @@ int main(int argc, char **argv) {
 
         if (is_image_mode) {
             // Default to fill mode for images (unless user specified otherwise)
-            if (!stretch_mode && panscan_value == 1.0f && !fill_mode) {
-                fill_mode = true;
-                if (VERBOSE)
-                    cflp_info("Image detected, defaulting to fill mode");
-            }
+            apply_image_fill_default(true);
             init_image_pipeline();
         } else {
             init_gst(&state);
@@ -4047,18 +7576,37 @@ int main(int argc, char **argv) {
         return EXIT_FAILURE;
     }
 
-    // Start monitoring threads after surfaces are ready
-    init_threads();
+    init_idle_notification(&state);
+
+    // Start timers and process monitoring after surfaces are ready
+    init_event_sources();
 
     // Main Loop
     while (true) {
-        struct pollfd fds[3];
-        fds[0].fd = wl_display_get_fd(state.display);
-        fds[0].events = POLLIN;
-        fds[1].fd = wakeup_pipe[0];
-        fds[1].events = POLLIN;
-        fds[2].fd = ipc_socket_path ? ipc_get_wakeup_fd() : -1;
-        fds[2].events = POLLIN;
+        // Suspend or resume playback before waiting; wakes up in time to notice starvation
+        int visibility_timeout = update_visibility(&state);
+
+        // The bus is replaced when an image pipeline is rebuilt, so ask for its fd every time
+        GPollFD bus_fd = { .fd = -1 };
+        if (bus)
+            gst_bus_get_pollfd(bus, &bus_fd);
+
+        // Unused sources have fd -1, which poll() skips
+        enum {
+            POLL_WAYLAND, POLL_WAKEUP, POLL_IPC, POLL_BUS, POLL_WATCH_LISTS, POLL_AUTO_STOP,
+            POLL_GIF_LOOP, POLL_SLIDESHOW, POLL_IMAGE_LOAD, POLL_COUNT
+        };
+        struct pollfd fds[POLL_COUNT] = {
+            [POLL_WAYLAND] = { .fd = wl_display_get_fd(state.display), .events = POLLIN },
+            [POLL_WAKEUP] = { .fd = wakeup_fd, .events = POLLIN },
+            [POLL_IPC] = { .fd = ipc_socket_path ? ipc_get_wakeup_fd() : -1, .events = POLLIN },
+            [POLL_BUS] = { .fd = bus_fd.fd, .events = POLLIN },
+            [POLL_WATCH_LISTS] = { .fd = watch_lists_fd(), .events = POLLIN },
+            [POLL_AUTO_STOP] = { .fd = auto_stop_timer_fd, .events = POLLIN },
+            [POLL_GIF_LOOP] = { .fd = gif_loop_timer_fd, .events = POLLIN },
+            [POLL_SLIDESHOW] = { .fd = slideshow_timer_fd, .events = POLLIN },
+            [POLL_IMAGE_LOAD] = { .fd = image_load.timer_fd, .events = POLLIN },
+        };
 
         // First make sure to call wl_display_prepare_read() before poll() to avoid deadlock
         int wl_display_prepare_read_state = wl_display_prepare_read(state.display);
@@ -4067,10 +7615,12 @@ int main(int argc, char **argv) {
         if (wl_display_flush(state.display) == -1 && errno != EAGAIN)
             break;
 
-        // Wait for a GStreamer callback, IPC command, or wl_display event
-        int nfds = ipc_socket_path ? 3 : 2;
-        int poll_timeout = transition_state.active ? 16 : 50;  // Faster polling during transitions
-        int poll_result = poll(fds, nfds, poll_timeout);
+        // Wait for a GStreamer callback or message, IPC command, timer, process event or wl_display event.
+        // Only transitions and visibility checks need a timeout; otherwise sleep until woken
+        int poll_timeout = transition_state.active ? 16 : -1;
+        if (visibility_timeout >= 0 && (poll_timeout < 0 || visibility_timeout < poll_timeout))
+            poll_timeout = visibility_timeout;
+        int poll_result = poll(fds, POLL_COUNT, poll_timeout);
         if (poll_result == -1 && errno != EINTR)
             break;
 
@@ -4083,7 +7633,7 @@ int main(int argc, char **argv) {
         // If wl_display_prepare_read() was successful as 0
         if (wl_display_prepare_read_state == 0) {
             // Read if we have wl_display events after poll()
-            if (fds[0].revents & POLLIN) {
+            if (fds[POLL_WAYLAND].revents & POLLIN) {
                 wl_display_read_events(state.display);
             } else { // Otherwise we must cancel the read
                 wl_display_cancel_read(state.display);
@@ -4101,15 +7651,22 @@ int main(int argc, char **argv) {
         }
 
         // Handle frame rendering
-        if (fds[1].revents & POLLIN) {
-            // Empty the pipe
-            char tmp[64];
-            if (read(wakeup_pipe[0], tmp, sizeof(tmp)) == -1)
-                break;
+        if (fds[POLL_WAKEUP].revents & POLLIN) {
+            // Reset the eventfd counter
+            drain_loop_fd(wakeup_fd);
+
+            // Threaded outputs draw on their own once the frame is uploaded
+            sync_render_threads(&state);
+            if (render_threads_running(&state))
+                publish_render_frame(&state);
+            else
+                upload_frame_stage();
 
             // Draw frame for all outputs
             struct display_output *output;
             wl_list_for_each(output, &state.outputs, link) {
+                if (output->render_thread)
+                    continue;
                 // Redraw immediately if not waiting for frame callback
                 if (output->frame_callback == NULL) {
                     // Avoid crash when output is destroyed
@@ -4125,13 +7682,31 @@ int main(int argc, char **argv) {
         }
 
         // Handle IPC commands
-        if (ipc_socket_path && fds[2].revents & POLLIN) {
+        if (ipc_socket_path && fds[POLL_IPC].revents & POLLIN) {
             if (VERBOSE == 2)
                 cflp_info("Main loop: Processing IPC commands");
             execute_ipc_commands();
             if (VERBOSE == 2)
                 cflp_info("Main loop: IPC commands processed");
+            // A change may have switched between video and image or started a transition
+            sync_render_threads(&state);
         }
+
+        // GStreamer bus messages (errors, loop seeks, state changes) and the GIF loop delay
+        if (fds[POLL_BUS].revents & POLLIN)
+            dispatch_bus_messages();
+        if (fds[POLL_GIF_LOOP].revents & POLLIN)
+            handle_gif_loop_timer();
+
+        // Pauselist/stoplist process events, the auto-stop deadman timer and the slideshow tick
+        if (fds[POLL_WATCH_LISTS].revents & POLLIN)
+            handle_watch_lists();
+        if (fds[POLL_AUTO_STOP].revents & POLLIN)
+            handle_auto_stop();
+        if (fds[POLL_SLIDESHOW].revents & POLLIN)
+            handle_slideshow_timer();
+        if (fds[POLL_IMAGE_LOAD].revents & POLLIN)
+            handle_image_load_timer();
         
         // During transitions, force continuous rendering
         // We can't rely on frame callbacks for smooth transitions
@@ -0,0 +1,427 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include "preload.h"
+#include "cache.h"
+#include "diskcache.h"
+#include "cflogprinter.h"
+
+// Give up on an image that has not prerolled by then (same as the image pipeline)
+#define PRELOAD_DECODE_TIMEOUT_MS 5000
+// How often a running decode checks for cancellation
+#define PRELOAD_CANCEL_POLL_MS 50
+
+typedef struct preload_job {
+    char *path;
+    cache_entry_t *pack;           // Cached entry to compress instead of decoding path
+    struct preload_job *next;
+} preload_job_t;
+
+// A worker and the job it is decoding
+typedef struct {
+    pthread_t thread;
+    char *path;                    // Job being decoded, NULL when idle
+    bool packing;                  // Job compresses a cached entry (preload_pack())
+    bool cancelled;                // Set by preload_cancel(); the result is dropped
+} preload_worker_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;           // Signals queued jobs and shutdown
+    preload_job_t *head, *tail;
+    int queued;
+    preload_worker_t workers[PRELOAD_WORKERS];
+    int n_workers;
+    bool stopping;
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static bool is_gif_path(const char *path) {
+    const char *ext = strrchr(path, '.');
+    return ext && strcasecmp(ext, ".gif") == 0;
+}
+
+static bool worker_cancelled(preload_worker_t *worker) {
+    pthread_mutex_lock(&pool.lock);
+    bool cancelled = worker->cancelled || pool.stopping;
+    pthread_mutex_unlock(&pool.lock);
+    return cancelled;
+}
+
+static void on_pad_added(GstElement *decodebin, GstPad *pad, gpointer data) {
+    GstElement *convert = (GstElement *)data;
+    GstPad *sink_pad = gst_element_get_static_pad(convert, "sink");
+    if (!gst_pad_is_linked(sink_pad)) {
+        GstCaps *caps = gst_pad_get_current_caps(pad);
+        if (!caps)
+            caps = gst_pad_query_caps(pad, NULL);
+        const gchar *name = gst_structure_get_name(gst_caps_get_structure(caps, 0));
+        if (g_str_has_prefix(name, "video/"))
+            gst_pad_link(pad, sink_pad);
+        gst_caps_unref(caps);
+    }
+    gst_object_unref(sink_pad);
+}
+
+// A decoded image and what owns its pixels, for cache_entry_wrap()
+typedef struct {
+    const unsigned char *data;     // Tightly packed RGBA, NULL if nothing was decoded
+    int width, height;
+    cache_release_fn release;      // NULL: data came from malloc
+    void *owner;
+} decoded_image_t;
+
+static void release_video_frame(void *owner) {
+    GstVideoFrame *frame = owner;
+    gst_video_frame_unmap(frame);
+    free(frame);
+}
+
+// Take the prerolled frame as tightly packed RGBA (the cache layout). Rows
+// without padding stay in the mapped buffer, which the cache entry then
+// keeps; padded rows are copied out.
+// CHANGED 2026-10-16 - Keep the mapped preroll buffer - Problem: every preload copied the whole image once more
+static bool take_preroll(GstElement *appsink, decoded_image_t *image) {
+    GstSample *sample = NULL;
+    g_signal_emit_by_name(appsink, "pull-preroll", &sample);
+    if (!sample)
+        return false;
+
+    GstVideoInfo info;
+    GstVideoFrame *frame = calloc(1, sizeof(GstVideoFrame));
+    // The mapped frame holds its own buffer reference
+    if (frame && gst_video_info_from_caps(&info, gst_sample_get_caps(sample)) &&
+        gst_video_frame_map(frame, &info, gst_sample_get_buffer(sample), GST_MAP_READ)) {
+        int w = GST_VIDEO_INFO_WIDTH(&info);
+        int h = GST_VIDEO_INFO_HEIGHT(&info);
+        size_t row = (size_t)w * 4;
+        const guint8 *src = GST_VIDEO_FRAME_PLANE_DATA(frame, 0);
+        int stride = GST_VIDEO_FRAME_PLANE_STRIDE(frame, 0);
+        if ((size_t)stride == row) {
+            *image = (decoded_image_t){ src, w, h, release_video_frame, frame };
+            frame = NULL;
+        } else {
+            unsigned char *pixels = malloc(row * h);
+            if (pixels) {
+                for (int y = 0; y < h; y++)
+                    memcpy(pixels + row * y, src + (size_t)stride * y, row);
+                *image = (decoded_image_t){ pixels, w, h, NULL, NULL };
+            }
+            gst_video_frame_unmap(frame);
+        }
+    }
+    free(frame);
+    gst_sample_unref(sample);
+    return image->data != NULL;
+}
+
+// Decode path to RGBA with a private pipeline:
+// filesrc ! (decodebin | gdkpixbufdec) ! videoconvert ! appsink, prerolled in PAUSED.
+// Leaves image empty on error, timeout or cancellation.
+static void decode_image(preload_worker_t *worker, const char *path, decoded_image_t *image) {
+    bool use_pixbuf_decoder = is_gif_path(path);
+    GstElement *pipeline = gst_pipeline_new(NULL);
+    GstElement *filesrc = gst_element_factory_make("filesrc", NULL);
+    GstElement *decoder = gst_element_factory_make(use_pixbuf_decoder ? "gdkpixbufdec" : "decodebin", NULL);
+    GstElement *convert = gst_element_factory_make("videoconvert", NULL);
+    GstElement *appsink = gst_element_factory_make("appsink", NULL);
+    if (!pipeline || !filesrc || !decoder || !convert || !appsink) {
+        cflp_warning("Preload: failed to create decode elements");
+        // Nothing is in a bin yet, so each reference is still floating
+        GstElement *elements[] = { pipeline, filesrc, decoder, convert, appsink };
+        for (size_t i = 0; i < G_N_ELEMENTS(elements); i++) {
+            if (elements[i])
+                gst_object_unref(gst_object_ref_sink(elements[i]));
+        }
+        return;
+    }
+
+    g_object_set(G_OBJECT(filesrc), "location", path, NULL);
+    GstCaps *caps = gst_caps_from_string("video/x-raw,format=RGBA");
+    g_object_set(G_OBJECT(appsink), "caps", caps, "sync", FALSE, NULL);
+    gst_caps_unref(caps);
+
+    gst_bin_add_many(GST_BIN(pipeline), filesrc, decoder, convert, appsink, NULL);
+    bool linked = gst_element_link(filesrc, decoder) && gst_element_link(convert, appsink);
+    if (use_pixbuf_decoder)
+        linked = linked && gst_element_link(decoder, convert);
+    else
+        g_signal_connect(decoder, "pad-added", G_CALLBACK(on_pad_added), convert);
+
+    if (!linked) {
+        cflp_warning("Preload: failed to link decode pipeline for %s", path);
+    } else if (gst_element_set_state(pipeline, GST_STATE_PAUSED) == GST_STATE_CHANGE_FAILURE) {
+        cflp_warning("Preload: failed to start decoding %s", path);
+    } else {
+        // Wait for preroll in short steps so cancellation is noticed quickly
+        GstBus *bus = gst_element_get_bus(pipeline);
+        for (int waited = 0; waited < PRELOAD_DECODE_TIMEOUT_MS && !worker_cancelled(worker);
+             waited += PRELOAD_CANCEL_POLL_MS) {
+            GstMessage *msg = gst_bus_timed_pop_filtered(bus, PRELOAD_CANCEL_POLL_MS * GST_MSECOND,
+                                                         GST_MESSAGE_ASYNC_DONE | GST_MESSAGE_ERROR);
+            if (!msg)
+                continue;
+            bool done = true;
+            if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+                GError *error = NULL;
+                gst_message_parse_error(msg, &error, NULL);
+                cflp_warning("Preload: failed to decode %s: %s", path, error->message);
+                g_error_free(error);
+            } else if (GST_MESSAGE_SRC(msg) == GST_OBJECT(pipeline)) {
+                take_preroll(appsink, image);
+            } else {
+                done = false;  // A child's ASYNC_DONE; wait for the pipeline's
+            }
+            gst_message_unref(msg);
+            if (done)
+                break;
+        }
+        gst_object_unref(bus);
+    }
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+}
+
+static void *worker_main(void *data) {
+    preload_worker_t *worker = data;
+
+    pthread_mutex_lock(&pool.lock);
+    while (!pool.stopping) {
+        if (!pool.head) {
+            pthread_cond_wait(&pool.cond, &pool.lock);
+            continue;
+        }
+
+        preload_job_t *job = pool.head;
+        pool.head = job->next;
+        if (!pool.head)
+            pool.tail = NULL;
+        pool.queued--;
+        worker->path = job->path;
+        worker->packing = job->pack != NULL;
+        worker->cancelled = false;
+        cache_entry_t *pack = job->pack;
+        free(job);
+        pthread_mutex_unlock(&pool.lock);
+
+        if (pack) {
+            // cache_replace() only swaps pack out while it is still cached,
+            // so an unload meanwhile needs no cancellation check
+            cache_entry_t *packed = cache_pack(pack);
+            if (packed != pack)
+                cache_replace(pack, packed);
+            cache_entry_unref(packed);
+            cache_entry_unref(pack);
+
+            pthread_mutex_lock(&pool.lock);
+            free(worker->path);
+            worker->path = NULL;
+            worker->packing = false;
+            continue;
+        }
+
+        // A change may have cached it while the job waited
+        decoded_image_t image = {0};
+        if (!cache_contains(worker->path))
+            decode_image(worker, worker->path, &image);
+
+        // Compress (--cache-compress) before taking the lock
+        cache_entry_t *rgba = NULL, *packed = NULL;
+        if (image.data) {
+            rgba = cache_entry_wrap(image.data, image.width, image.height, image.release, image.owner);
+            packed = cache_pack(rgba);
+        }
+
+        pthread_mutex_lock(&pool.lock);
+        if (packed && !worker->cancelled && !pool.stopping) {
+            // Added under pool.lock so an `unload` (cancel, then cache_remove())
+            // either stops this add or removes what it added
+            cache_entry_unref(cache_insert(worker->path, packed));
+            diskcache_store(worker->path, rgba);
+        }
+        cache_entry_unref(packed);
+        cache_entry_unref(rgba);
+        free(worker->path);
+        worker->path = NULL;
+    }
+    pthread_mutex_unlock(&pool.lock);
+    return NULL;
+}
+
+// Caller holds pool.lock
+static bool start_workers_locked(void) {
+    if (pool.n_workers > 0)
+        return true;
+
+    gst_init(NULL, NULL);
+    for (int i = 0; i < PRELOAD_WORKERS; i++) {
+        if (pthread_create(&pool.workers[i].thread, NULL, worker_main, &pool.workers[i]) != 0)
+            break;
+        pool.n_workers++;
+    }
+    if (pool.n_workers == 0) {
+        cflp_error("Preload: failed to start decode threads");
+        return false;
+    }
+    return true;
+}
+
+preload_result_t preload_submit(const char *path) {
+    pthread_mutex_lock(&pool.lock);
+
+    // Deduplicate against running and queued jobs
+    for (int i = 0; i < pool.n_workers; i++) {
+        if (pool.workers[i].path && !pool.workers[i].packing && !pool.workers[i].cancelled &&
+            strcmp(pool.workers[i].path, path) == 0) {
+            pthread_mutex_unlock(&pool.lock);
+            return PRELOAD_PENDING;
+        }
+    }
+    for (preload_job_t *job = pool.head; job; job = job->next) {
+        if (!job->pack && strcmp(job->path, path) == 0) {
+            pthread_mutex_unlock(&pool.lock);
+            return PRELOAD_PENDING;
+        }
+    }
+    if (pool.queued >= PRELOAD_QUEUE_MAX) {
+        pthread_mutex_unlock(&pool.lock);
+        return PRELOAD_QUEUE_FULL;
+    }
+
+    preload_job_t *job = calloc(1, sizeof(*job));
+    if (!job || !(job->path = strdup(path)) || !start_workers_locked()) {
+        if (job)
+            free(job->path);
+        free(job);
+        pthread_mutex_unlock(&pool.lock);
+        return PRELOAD_FAILED;
+    }
+
+    if (pool.tail)
+        pool.tail->next = job;
+    else
+        pool.head = job;
+    pool.tail = job;
+    pool.queued++;
+    pthread_cond_signal(&pool.cond);
+    pthread_mutex_unlock(&pool.lock);
+    return PRELOAD_QUEUED;
+}
+
+bool preload_pack(cache_entry_t *entry) {
+    if (!entry || cache_compression() == CACHE_COMPRESS_OFF || !cache_lossless_available())
+        return false;
+
+    pthread_mutex_lock(&pool.lock);
+    preload_job_t *job = NULL;
+    if (pool.queued < PRELOAD_QUEUE_MAX)
+        job = calloc(1, sizeof(*job));
+    if (!job || !(job->path = strdup(entry->path)) || !start_workers_locked()) {
+        if (job)
+            free(job->path);
+        free(job);
+        pthread_mutex_unlock(&pool.lock);
+        return false;
+    }
+    job->pack = cache_entry_ref(entry);
+
+    if (pool.tail)
+        pool.tail->next = job;
+    else
+        pool.head = job;
+    pool.tail = job;
+    pool.queued++;
+    pthread_cond_signal(&pool.cond);
+    pthread_mutex_unlock(&pool.lock);
+    return true;
+}
+
+int preload_cancel(const char *path) {
+    int count = 0;
+    pthread_mutex_lock(&pool.lock);
+
+    preload_job_t **link = &pool.head;
+    pool.tail = NULL;
+    while (*link) {
+        preload_job_t *job = *link;
+        if (!path || strcmp(job->path, path) == 0) {
+            *link = job->next;
+            if (!job->pack)
+                count++;
+            cache_entry_unref(job->pack);
+            free(job->path);
+            free(job);
+            pool.queued--;
+        } else {
+            pool.tail = job;
+            link = &job->next;
+        }
+    }
+
+    for (int i = 0; i < pool.n_workers; i++) {
+        preload_worker_t *worker = &pool.workers[i];
+        if (worker->path && !worker->packing && !worker->cancelled &&
+            (!path || strcmp(worker->path, path) == 0)) {
+            worker->cancelled = true;
+            count++;
+        }
+    }
+
+    pthread_mutex_unlock(&pool.lock);
+    return count;
+}
+
+void preload_list(char *buffer, size_t buflen) {
+    if (!buffer || buflen == 0) return;
+
+    buffer[0] = '\0';
+    size_t offset = 0;
+
+    pthread_mutex_lock(&pool.lock);
+    for (int i = 0; i < pool.n_workers; i++) {
+        const preload_worker_t *worker = &pool.workers[i];
+        if (!worker->path || worker->packing || worker->cancelled)
+            continue;
+        int written = snprintf(buffer + offset, buflen - offset, "PRELOAD: decoding %s\n", worker->path);
+        if (written < 0 || (size_t)written >= buflen - offset)
+            break;  // Buffer full
+        offset += written;
+    }
+    for (preload_job_t *job = pool.head; job; job = job->next) {
+        if (job->pack)
+            continue;
+        int written = snprintf(buffer + offset, buflen - offset, "PRELOAD: queued %s\n", job->path);
+        if (written < 0 || (size_t)written >= buflen - offset)
+            break;  // Buffer full
+        offset += written;
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    if (offset == 0)
+        snprintf(buffer, buflen, "PRELOAD: (none)\n");
+}
+
+void preload_shutdown(void) {
+    preload_cancel(NULL);
+
+    pthread_mutex_lock(&pool.lock);
+    pool.stopping = true;
+    pthread_cond_broadcast(&pool.cond);
+    int n_workers = pool.n_workers;
+    pthread_mutex_unlock(&pool.lock);
+
+    for (int i = 0; i < n_workers; i++)
+        pthread_join(pool.workers[i].thread, NULL);
+
+    pthread_mutex_lock(&pool.lock);
+    pool.n_workers = 0;
+    pool.stopping = false;
+    pthread_mutex_unlock(&pool.lock);
+}
@@ -0,0 +1,376 @@
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include "procmon.h"
+
+// Longest name the kernel keeps in /proc/<pid>/comm (TASK_COMM_LEN - 1)
+#define COMM_MAX 15
+
+// How long to wait for the kernel to acknowledge the subscription
+#define PROC_CN_ACK_TIMEOUT_MS 200
+
+// A running process whose comm matches a watched name
+typedef struct {
+    pid_t pid;
+    int name;                      // Index into procmon::names
+} tracked_proc_t;
+
+struct procmon {
+    char **names;                  // Watched names, borrowed from the lists
+    int n_names;
+    tracked_proc_t *procs;         // Matching processes currently running
+    size_t n_procs;
+    size_t cap_procs;
+    int fd;                        // Proc connector socket, -1 when scanning /proc
+};
+
+// Same rule as pidof: comm is truncated to 15 bytes, so a longer name
+// matches on its first 15 characters
+static bool name_matches(const char *name, const char *comm) {
+    if (strlen(name) > COMM_MAX)
+        return strncmp(name, comm, COMM_MAX) == 0;
+    return strcmp(name, comm) == 0;
+}
+
+// Read /proc/<pid>/comm without the trailing newline
+static bool read_comm(pid_t pid, char *comm, size_t size) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/comm", (int)pid);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    ssize_t len = read(fd, comm, size - 1);
+    close(fd);
+    if (len <= 0)
+        return false;
+
+    comm[len] = '\0';
+    if (comm[len - 1] == '\n')
+        comm[len - 1] = '\0';
+    return true;
+}
+
+// Index of the first watched name matching comm, or -1
+static int match_name(const procmon_t *pm, const char *comm) {
+    for (int i = 0; i < pm->n_names; i++) {
+        if (name_matches(pm->names[i], comm))
+            return i;
+    }
+    return -1;
+}
+
+static void track(procmon_t *pm, pid_t pid, int name) {
+    for (size_t i = 0; i < pm->n_procs; i++) {
+        if (pm->procs[i].pid == pid) {
+            pm->procs[i].name = name;
+            return;
+        }
+    }
+    if (pm->n_procs == pm->cap_procs) {
+        size_t cap = pm->cap_procs ? pm->cap_procs * 2 : 16;
+        tracked_proc_t *procs = realloc(pm->procs, cap * sizeof(*procs));
+        if (!procs)
+            return;
+        pm->procs = procs;
+        pm->cap_procs = cap;
+    }
+    pm->procs[pm->n_procs++] = (tracked_proc_t){ .pid = pid, .name = name };
+}
+
+static void untrack(procmon_t *pm, pid_t pid) {
+    for (size_t i = 0; i < pm->n_procs; i++) {
+        if (pm->procs[i].pid == pid) {
+            pm->procs[i] = pm->procs[--pm->n_procs];
+            return;
+        }
+    }
+}
+
+static int tracked_name(const procmon_t *pm, pid_t pid) {
+    for (size_t i = 0; i < pm->n_procs; i++) {
+        if (pm->procs[i].pid == pid)
+            return pm->procs[i].name;
+    }
+    return -1;
+}
+
+// Re-read comm of a process whose image or name changed
+static void recheck(procmon_t *pm, pid_t pid) {
+    char comm[COMM_MAX + 2];
+    int name = read_comm(pid, comm, sizeof(comm)) ? match_name(pm, comm) : -1;
+
+    if (name >= 0)
+        track(pm, pid, name);
+    else
+        untrack(pm, pid);
+}
+
+// Rebuild the running set from /proc
+static void scan_proc(procmon_t *pm) {
+    pm->n_procs = 0;
+
+    DIR *dir = opendir("/proc");
+    if (!dir)
+        return;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!isdigit((unsigned char)entry->d_name[0]))
+            continue;
+
+        pid_t pid = (pid_t)strtol(entry->d_name, NULL, 10);
+        char comm[COMM_MAX + 2];
+        if (!read_comm(pid, comm, sizeof(comm)))
+            continue;
+
+        int name = match_name(pm, comm);
+        if (name >= 0)
+            track(pm, pid, name);
+    }
+    closedir(dir);
+}
+
+static int64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+// The event follows the 20-byte cn_msg header, so it is not aligned for direct access
+static void read_proc_event(const struct cn_msg *cn, struct proc_event *ev) {
+    memset(ev, 0, sizeof(*ev));
+    memcpy(ev, cn->data, cn->len < sizeof(*ev) ? cn->len : sizeof(*ev));
+}
+
+// Send a proc connector multicast op; the kernel acknowledges it with a
+// PROC_EVENT_NONE whose cn_msg ack is ours plus one
+static bool send_mcast_op(int fd, enum proc_cn_mcast_op op) {
+    struct {
+        struct nlmsghdr nl;
+        struct cn_msg cn;
+        enum proc_cn_mcast_op op;
+    } __attribute__((packed)) msg = {
+        .nl = {
+            .nlmsg_len = sizeof(msg),
+            .nlmsg_type = NLMSG_DONE,
+        },
+        .cn = {
+            .id = { .idx = CN_IDX_PROC, .val = CN_VAL_PROC },
+            .ack = (uint32_t)getpid(),
+            .len = sizeof(enum proc_cn_mcast_op),
+        },
+        .op = op,
+    };
+    return send(fd, &msg, sizeof(msg), 0) >= 0;
+}
+
+// Wait for the kernel to acknowledge PROC_CN_MCAST_LISTEN. A kernel that
+// ignores LISTEN (from a non-init user or pid namespace) sends no ack and
+// no events either, so without one the /proc scan has to be used.
+static bool wait_for_listen_ack(int fd) {
+    char buf[4096] __attribute__((aligned(NLMSG_ALIGNTO)));
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    int64_t deadline_ms = monotonic_ms() + PROC_CN_ACK_TIMEOUT_MS;
+
+    for (;;) {
+        int64_t left_ms = deadline_ms - monotonic_ms();
+        if (left_ms <= 0)
+            return false;
+        int ret = poll(&pfd, 1, (int)left_ms);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return false;
+
+        ssize_t len = recv(fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return false;
+        }
+
+        // Events that arrive first are dropped; procmon_create() scans /proc afterwards
+        for (struct nlmsghdr *nl = (struct nlmsghdr *)buf; NLMSG_OK(nl, (size_t)len);
+             nl = NLMSG_NEXT(nl, len)) {
+            if (nl->nlmsg_type == NLMSG_ERROR || nl->nlmsg_type == NLMSG_NOOP)
+                continue;
+            struct cn_msg *cn = NLMSG_DATA(nl);
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC)
+                continue;
+            struct proc_event ev;
+            read_proc_event(cn, &ev);
+            if (ev.what == PROC_EVENT_NONE && cn->ack == (uint32_t)getpid() + 1)
+                return ev.event_data.ack.err == 0;
+        }
+    }
+}
+
+// Subscribe to process events; needs CAP_NET_ADMIN on most kernels
+static int open_proc_connector(void) {
+    int fd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_CONNECTOR);
+    if (fd < 0)
+        return -1;
+
+    struct sockaddr_nl addr = {
+        .nl_family = AF_NETLINK,
+        .nl_groups = CN_IDX_PROC,
+        .nl_pid = 0,
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Binding can succeed where LISTEN is ignored; only the ack tells
+    if (!send_mcast_op(fd, PROC_CN_MCAST_LISTEN) || !wait_for_listen_ack(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void handle_proc_event(procmon_t *pm, const struct proc_event *ev) {
+    switch (ev->what) {
+    case PROC_EVENT_FORK:
+        // A new process (not a thread) starts with its parent's comm
+        if (ev->event_data.fork.child_pid == ev->event_data.fork.child_tgid) {
+            int name = tracked_name(pm, ev->event_data.fork.parent_tgid);
+            if (name >= 0)
+                track(pm, ev->event_data.fork.child_tgid, name);
+        }
+        break;
+    case PROC_EVENT_EXEC:
+        recheck(pm, ev->event_data.exec.process_tgid);
+        break;
+    case PROC_EVENT_COMM:
+        if (ev->event_data.comm.process_pid == ev->event_data.comm.process_tgid)
+            recheck(pm, ev->event_data.comm.process_tgid);
+        break;
+    case PROC_EVENT_EXIT:
+        if (ev->event_data.exit.process_pid == ev->event_data.exit.process_tgid)
+            untrack(pm, ev->event_data.exit.process_tgid);
+        break;
+    default:
+        break;
+    }
+}
+
+procmon_t *procmon_create(char **const *lists, int n_lists) {
+    procmon_t *pm = calloc(1, sizeof(*pm));
+    if (!pm)
+        return NULL;
+    pm->fd = -1;
+
+    for (int l = 0; l < n_lists; l++) {
+        for (int i = 0; lists[l] && lists[l][i]; i++) {
+            char **names = realloc(pm->names, (pm->n_names + 1) * sizeof(char *));
+            if (!names) {
+                procmon_destroy(pm);
+                return NULL;
+            }
+            pm->names = names;
+            pm->names[pm->n_names++] = lists[l][i];
+        }
+    }
+
+    // Subscribe before the first scan so nothing starting in between is missed
+    pm->fd = open_proc_connector();
+    scan_proc(pm);
+    return pm;
+}
+
+void procmon_destroy(procmon_t *pm) {
+    if (!pm)
+        return;
+    if (pm->fd >= 0) {
+        // The kernel counts listeners; without IGNORE it keeps sending events for this one
+        send_mcast_op(pm->fd, PROC_CN_MCAST_IGNORE);
+        close(pm->fd);
+    }
+    free(pm->procs);
+    free(pm->names);
+    free(pm);
+}
+
+int procmon_get_fd(const procmon_t *pm) {
+    return pm->fd;
+}
+
+void procmon_update(procmon_t *pm) {
+    if (pm->fd < 0) {
+        scan_proc(pm);
+        return;
+    }
+
+    char buf[4096] __attribute__((aligned(NLMSG_ALIGNTO)));
+    for (;;) {
+        ssize_t len = recv(pm->fd, buf, sizeof(buf), 0);
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            // Socket buffer overran and events were lost: start over from /proc
+            if (errno == ENOBUFS)
+                scan_proc(pm);
+            return;
+        }
+        if (len == 0)
+            return;
+
+        for (struct nlmsghdr *nl = (struct nlmsghdr *)buf; NLMSG_OK(nl, (size_t)len);
+             nl = NLMSG_NEXT(nl, len)) {
+            if (nl->nlmsg_type == NLMSG_ERROR || nl->nlmsg_type == NLMSG_NOOP)
+                continue;
+            struct cn_msg *cn = NLMSG_DATA(nl);
+            if (cn->id.idx != CN_IDX_PROC || cn->id.val != CN_VAL_PROC)
+                continue;
+            struct proc_event ev;
+            read_proc_event(cn, &ev);
+            handle_proc_event(pm, &ev);
+        }
+    }
+}
+
+const char *procmon_find(const procmon_t *pm, char **list) {
+    for (int i = 0; list[i] != NULL; i++) {
+        for (size_t p = 0; p < pm->n_procs; p++) {
+            if (strcmp(pm->names[pm->procs[p].name], list[i]) == 0)
+                return list[i];
+        }
+    }
+    return NULL;
+}
+
+int procmon_scan(char **names, bool *running) {
+    // Plain /proc pass, no proc connector for a one-off check
+    procmon_t pm = { .names = names, .fd = -1 };
+    while (names[pm.n_names] != NULL)
+        pm.n_names++;
+    scan_proc(&pm);
+
+    int found = 0;
+    for (int i = 0; i < pm.n_names; i++) {
+        bool hit = false;
+        for (size_t p = 0; p < pm.n_procs && !hit; p++)
+            hit = strcmp(names[pm.procs[p].name], names[i]) == 0;
+        if (running)
+            running[i] = hit;
+        found += hit;
+    }
+
+    free(pm.procs);
+    return found;
+}
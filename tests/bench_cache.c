@@ -0,0 +1,108 @@
+// Image cache micro-benchmark.
+// Times cache_add, cache_get, cache_contains and LRU eviction with 10k
+// entries. Entries are 100 bytes so that all of them fit in a 1 MB cache
+// and the eviction pass evicts one entry per add from a full cache.
+//
+//   meson setup build && meson compile -C build bench_cache && ./build/bench_cache
+//
+// cache.c logs every add and eviction to stdout, so stdout is discarded
+// while timing and results go to stderr.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "cache.h"
+
+#define BENCH_ENTRIES 10000
+#define BENCH_WIDTH 25    // 25x1 RGBA = 100 bytes
+#define BENCH_CACHE_MB 1
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static void path_for(char *buf, size_t len, int i) {
+    snprintf(buf, len, "/home/user/Pictures/wallpapers/collection/image-%05d.png", i);
+}
+
+static void report(const char *name, double ms, int ops) {
+    fprintf(stderr, "%-10s %6d ops %9.3f ms %8.1f ns/op\n", name, ops, ms, ms * 1e6 / ops);
+}
+
+int main(void) {
+    char path[256];
+    int failures = 0;
+
+    if (!freopen("/dev/null", "w", stdout)) {
+        perror("freopen");
+        return 1;
+    }
+
+    cache_init(BENCH_CACHE_MB);
+
+    double start = now_ms();
+    for (int i = 0; i < BENCH_ENTRIES; i++) {
+        path_for(path, sizeof(path), i);
+        cache_entry_t *entry = cache_add(path, malloc(BENCH_WIDTH * 4), BENCH_WIDTH, 1);
+        if (!entry)
+            failures++;
+        cache_entry_unref(entry);
+    }
+    report("add", now_ms() - start, BENCH_ENTRIES);
+
+    // Displayed entries move to their own list and must survive eviction
+    path_for(path, sizeof(path), 0);
+    cache_set_displayed(path, true);
+
+    start = now_ms();
+    for (int i = 0; i < BENCH_ENTRIES; i++) {
+        path_for(path, sizeof(path), (i * 7919) % BENCH_ENTRIES);
+        cache_entry_t *entry = cache_get(path);
+        if (!entry)
+            failures++;
+        cache_entry_unref(entry);
+    }
+    report("get", now_ms() - start, BENCH_ENTRIES);
+
+    start = now_ms();
+    for (int i = 0; i < BENCH_ENTRIES; i++) {
+        path_for(path, sizeof(path), BENCH_ENTRIES + i);
+        if (cache_contains(path))
+            failures++;
+    }
+    report("miss", now_ms() - start, BENCH_ENTRIES);
+
+    // Cache is full: every add evicts the least recently used entry
+    start = now_ms();
+    for (int i = 0; i < BENCH_ENTRIES; i++) {
+        path_for(path, sizeof(path), BENCH_ENTRIES + i);
+        cache_entry_t *entry = cache_add(path, malloc(BENCH_WIDTH * 4), BENCH_WIDTH, 1);
+        if (!entry)
+            failures++;
+        cache_entry_unref(entry);
+    }
+    report("evict", now_ms() - start, BENCH_ENTRIES);
+
+    path_for(path, sizeof(path), 0);
+    if (!cache_contains(path)) {
+        fprintf(stderr, "displayed entry was evicted\n");
+        failures++;
+    }
+    path_for(path, sizeof(path), 1);
+    if (cache_contains(path)) {
+        fprintf(stderr, "least recently used entry survived eviction\n");
+        failures++;
+    }
+
+    int entries = 0;
+    cache_stats(NULL, NULL, &entries);
+    fprintf(stderr, "%d entries cached\n", entries);
+
+    cache_shutdown();
+
+    if (failures)
+        fprintf(stderr, "%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,136 @@
+#!/bin/bash
+# Decoder selection tests for --decoder.
+# Runs on software-only machines: "sw" must plug a software decoder, "hw"
+# must fall back to software when no hardware decoder handles the stream,
+# and "hw-only" must either plug a hardware decoder or refuse to start.
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+GSLAPPER="$PROJECT_ROOT/build/gslapper"
+
+TESTS_PASSED=0
+TESTS_FAILED=0
+
+pass() {
+    echo "PASS: $1"
+    TESTS_PASSED=$((TESTS_PASSED + 1))
+}
+
+fail() {
+    echo "FAIL: $1"
+    TESTS_FAILED=$((TESTS_FAILED + 1))
+}
+
+skip() {
+    echo "SKIP: $1"
+}
+
+echo "=== gSlapper Decoder Selection Tests ==="
+echo ""
+
+if [[ ! -x "$GSLAPPER" ]]; then
+    fail "gslapper binary not found at $GSLAPPER"
+    echo "Run: ninja -C build"
+    exit 1
+fi
+
+if "$GSLAPPER" --help 2>&1 | grep -q -- "--decoder"; then
+    pass "--decoder option documented"
+else
+    fail "--decoder option missing from help"
+fi
+
+export WAYLAND_DISPLAY="${WAYLAND_DISPLAY:-wayland-1}"
+export XDG_RUNTIME_DIR="${XDG_RUNTIME_DIR:-/run/user/$(id -u)}"
+
+if [[ ! -S "$XDG_RUNTIME_DIR/$WAYLAND_DISPLAY" ]]; then
+    skip "No Wayland display at $XDG_RUNTIME_DIR/$WAYLAND_DISPLAY - cannot run live decoder tests"
+    exit 0
+fi
+
+WORK_DIR="$(mktemp -d)"
+SOCKET_PATH="$WORK_DIR/ipc.sock"
+cleanup() {
+    pkill -9 -f "$WORK_DIR" 2>/dev/null
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+if ! gst-launch-1.0 -q videotestsrc num-buffers=150 ! vp8enc deadline=1 \
+        ! webmmux ! filesink location="$WORK_DIR/test.webm" 2>/dev/null; then
+    skip "Could not generate test video (vp8enc missing?)"
+    exit 0
+fi
+
+# Run gslapper with a decoder mode for a few seconds and capture its log
+run_mode() {
+    local mode=$1
+    "$GSLAPPER" -v --no-save-state --decoder "$mode" -I "$SOCKET_PATH" -o "loop no-audio" \
+        '*' "$WORK_DIR/test.webm" > "$WORK_DIR/$mode.log" 2>&1 &
+    local pid=$!
+    sleep 3
+    if kill -0 "$pid" 2>/dev/null; then
+        if command -v socat &> /dev/null; then
+            echo "query" | socat - UNIX-CONNECT:"$SOCKET_PATH" > "$WORK_DIR/$mode.query" 2>/dev/null
+        fi
+        kill -TERM "$pid" 2>/dev/null
+        wait "$pid" 2>/dev/null
+        return 0
+    fi
+    wait "$pid" 2>/dev/null
+    return 1
+}
+
+# Forced software decoding
+if run_mode sw; then
+    if grep -q "Video decoder: .* (software)" "$WORK_DIR/sw.log"; then
+        pass "--decoder sw plugs a software decoder"
+    else
+        fail "--decoder sw did not report a software decoder"
+    fi
+    if [[ -s "$WORK_DIR/sw.query" ]]; then
+        if grep -q "^DECODER: .* software sw" "$WORK_DIR/sw.query"; then
+            pass "query reports the software decoder"
+        else
+            fail "query did not report the decoder"
+        fi
+    else
+        skip "socat not available, skipping query check"
+    fi
+else
+    fail "--decoder sw failed to start"
+fi
+
+# Preferred hardware decoding falls back to software when nothing matches
+if run_mode hw; then
+    if grep -q "Video decoder: .* (hardware)" "$WORK_DIR/hw.log"; then
+        pass "--decoder hw plugs a hardware decoder"
+    elif grep -q "using software decoder" "$WORK_DIR/hw.log"; then
+        pass "--decoder hw falls back to software and reports it"
+    else
+        fail "--decoder hw did not report the decoder choice"
+    fi
+else
+    fail "--decoder hw failed to start"
+fi
+
+# Required hardware decoding either uses hardware or refuses to play
+if run_mode hw-only; then
+    if grep -q "Video decoder: .* (software)" "$WORK_DIR/hw-only.log"; then
+        fail "--decoder hw-only plugged a software decoder"
+    elif grep -q "Video decoder: .* (hardware)" "$WORK_DIR/hw-only.log"; then
+        pass "--decoder hw-only plugs a hardware decoder"
+    else
+        fail "--decoder hw-only kept running without reporting a hardware decoder"
+    fi
+else
+    if grep -qF -- "--decoder hw-only: no hardware video decoders are installed" "$WORK_DIR/hw-only.log"; then
+        pass "--decoder hw-only refuses to start without a hardware decoder"
+    else
+        fail "--decoder hw-only exited without explaining why"
+    fi
+fi
+
+echo ""
+echo "=== Results: $TESTS_PASSED passed, $TESTS_FAILED failed ==="
+[[ $TESTS_FAILED -eq 0 ]]
@@ -0,0 +1,132 @@
+#!/bin/bash
+# Loop point timing tests.
+# Plays a short clip on loop and reads loop_gap_ms/frame_ms from the IPC
+# "stats" command: with -o loop=gapless the gap between the last frame of a
+# loop and the first frame of the next must stay within two frame intervals.
+# The segment-seek loop is measured too and reported for comparison.
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+GSLAPPER="$PROJECT_ROOT/build/gslapper"
+
+TESTS_PASSED=0
+TESTS_FAILED=0
+
+pass() {
+    echo "PASS: $1"
+    TESTS_PASSED=$((TESTS_PASSED + 1))
+}
+
+fail() {
+    echo "FAIL: $1"
+    TESTS_FAILED=$((TESTS_FAILED + 1))
+}
+
+skip() {
+    echo "SKIP: $1"
+}
+
+echo "=== gSlapper Loop Gap Tests ==="
+echo ""
+
+if [[ ! -x "$GSLAPPER" ]]; then
+    fail "gslapper binary not found at $GSLAPPER"
+    echo "Run: ninja -C build"
+    exit 1
+fi
+
+if "$GSLAPPER" --help 2>&1 | grep -q "loop=gapless"; then
+    pass "loop=gapless documented"
+else
+    fail "loop=gapless missing from help"
+fi
+
+export WAYLAND_DISPLAY="${WAYLAND_DISPLAY:-wayland-1}"
+export XDG_RUNTIME_DIR="${XDG_RUNTIME_DIR:-/run/user/$(id -u)}"
+
+if [[ ! -S "$XDG_RUNTIME_DIR/$WAYLAND_DISPLAY" ]]; then
+    skip "No Wayland display at $XDG_RUNTIME_DIR/$WAYLAND_DISPLAY - cannot run live loop tests"
+    exit 0
+fi
+
+if ! command -v socat &> /dev/null; then
+    skip "socat not available - cannot query stats"
+    exit 0
+fi
+
+WORK_DIR="$(mktemp -d)"
+SOCKET_PATH="$WORK_DIR/ipc.sock"
+cleanup() {
+    pkill -9 -f "$WORK_DIR" 2>/dev/null
+    rm -rf "$WORK_DIR"
+}
+trap cleanup EXIT
+
+# One second at 30 fps, so a few seconds of playback crosses several loop points
+if ! gst-launch-1.0 -q videotestsrc num-buffers=30 ! video/x-raw,framerate=30/1 ! vp8enc deadline=1 \
+        ! webmmux ! filesink location="$WORK_DIR/test.webm" 2>/dev/null; then
+    skip "Could not generate test video (vp8enc missing?)"
+    exit 0
+fi
+
+# Play with the given -o options for a few seconds and save the stats line
+run_loop() {
+    local name=$1
+    local options=$2
+    "$GSLAPPER" -v --no-save-state -r auto -I "$SOCKET_PATH" -o "$options" \
+        '*' "$WORK_DIR/test.webm" > "$WORK_DIR/$name.log" 2>&1 &
+    local pid=$!
+    sleep 5
+    if ! kill -0 "$pid" 2>/dev/null; then
+        wait "$pid" 2>/dev/null
+        return 1
+    fi
+    echo "stats" | socat - UNIX-CONNECT:"$SOCKET_PATH" > "$WORK_DIR/$name.stats" 2>/dev/null
+    kill -TERM "$pid" 2>/dev/null
+    wait "$pid" 2>/dev/null
+    return 0
+}
+
+# Print the value of a key=value field from a stats line
+stat_field() {
+    sed -n "s/.* $2=\([0-9.]*\).*/\1/p" "$1"
+}
+
+if run_loop gapless "loop=gapless no-audio"; then
+    loops=$(stat_field "$WORK_DIR/gapless.stats" loops)
+    gap=$(stat_field "$WORK_DIR/gapless.stats" loop_gap_ms)
+    frame=$(stat_field "$WORK_DIR/gapless.stats" frame_ms)
+    if [[ -z "$loops" || -z "$gap" || -z "$frame" ]]; then
+        fail "stats did not report loops/loop_gap_ms/frame_ms"
+    elif [[ "$loops" -lt 2 ]]; then
+        fail "gapless loop did not restart the video (loops=$loops)"
+    else
+        pass "gapless loop restarted the video $loops times"
+        echo "      loop gap ${gap} ms, frame interval ${frame} ms"
+        if awk -v gap="$gap" -v frame="$frame" 'BEGIN { exit !(gap <= 2 * frame) }'; then
+            pass "gapless loop point within two frame intervals"
+        else
+            fail "gapless loop point took ${gap} ms (frame interval ${frame} ms)"
+        fi
+    fi
+else
+    fail "gslapper failed to start with loop=gapless"
+fi
+
+# Segment-seek looping, reported for comparison only
+if run_loop segment "loop no-audio"; then
+    gap=$(stat_field "$WORK_DIR/segment.stats" loop_gap_ms)
+    frame=$(stat_field "$WORK_DIR/segment.stats" frame_ms)
+    if [[ -n "$gap" && -n "$frame" ]]; then
+        pass "segment loop measured"
+        echo "      loop gap ${gap} ms, frame interval ${frame} ms"
+    else
+        fail "stats did not report the segment loop gap"
+    fi
+else
+    fail "gslapper failed to start with loop"
+fi
+
+echo ""
+echo "=== Results: $TESTS_PASSED passed, $TESTS_FAILED failed ==="
+[[ $TESTS_FAILED -eq 0 ]]